@@ -72,6 +72,12 @@ constexpr auto kNoUpdatesTimeout = 60 * 1000;
 // If nothing is received in 1 min when was a sleepmode we ping.
 constexpr auto kNoUpdatesAfterSleepTimeout = 60 * crl::time(1000);
 
+// Differences with more entries are prepared on a worker thread
+// and applied to Data::Session in time-sliced chunks.
+constexpr auto kDifferencePrepareThreshold = 200;
+constexpr auto kDifferenceMessagesChunk = 20;
+constexpr auto kDifferenceSliceDuration = crl::time(8);
+
 enum class DataIsLoadedResult {
 	NotLoaded = 0,
 	FromNotLoaded = 1,
@@ -220,6 +226,75 @@ DataIsLoadedResult AllDataLoadedForMessage(
 	});
 }
 
+
+template <typename Type, typename GetId, typename IsMin>
+[[nodiscard]] QVector<Type> DeduplicatedById(
+		const QVector<Type> &list,
+		GetId getId,
+		IsMin isMin) {
+	auto result = QVector<Type>();
+	result.reserve(list.size());
+	auto indices = base::flat_map<uint64, int>();
+	indices.reserve(list.size());
+	for (const auto &entry : list) {
+		const auto id = getId(entry);
+		const auto i = indices.find(id);
+		if (i == end(indices)) {
+			indices.emplace(id, int(result.size()));
+			result.push_back(entry);
+		} else if (!isMin(entry)) {
+			// Full data supersedes min data, later full data is newer.
+			result[i->second] = entry;
+		}
+	}
+	return result;
+}
+
+[[nodiscard]] QVector<MTPUser> DeduplicatedUsers(
+		const QVector<MTPUser> &list) {
+	return DeduplicatedById(list, [](const MTPUser &user) {
+		return uint64(user.match([](const auto &data) {
+			return data.vid().v;
+		}));
+	}, [](const MTPUser &user) {
+		return user.match([](const MTPDuser &data) {
+			return data.is_min();
+		}, [](const auto &) {
+			return false;
+		});
+	});
+}
+
+[[nodiscard]] QVector<MTPChat> DeduplicatedChats(
+		const QVector<MTPChat> &list) {
+	return DeduplicatedById(list, [](const MTPChat &chat) {
+		return chat.match([](const MTPDchatEmpty &data) {
+			return peerFromChat(data.vid()).value;
+		}, [](const MTPDchat &data) {
+			return peerFromChat(data.vid()).value;
+		}, [](const MTPDchatForbidden &data) {
+			return peerFromChat(data.vid()).value;
+		}, [](const auto &data) {
+			return peerFromChannel(data.vid()).value;
+		});
+	}, [](const MTPChat &chat) {
+		return chat.match([](const MTPDchannel &data) {
+			return data.is_min();
+		}, [](const auto &) {
+			return false;
+		});
+	});
+}
+
+[[nodiscard]] QVector<MTPMessage> SortedById(QVector<MTPMessage> list) {
+	// The same order Data::Session::processMessages applies to the whole
+	// list, so that processing it in chunks keeps the order across chats.
+	ranges::stable_sort(list, ranges::less(), [](const MTPMessage &message) {
+		return uint32(IdFromMessage(message).bare);
+	});
+	return list;
+}
+
 } // namespace
 
 Updates::Updates(not_null<Main::Session*> session)
@@ -474,23 +549,25 @@ void Updates::differenceDone(const MTPupdates_Difference &result) {
 	} break;
 	case mtpc_updates_differenceSlice: {
 		auto &d = result.c_updates_differenceSlice();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
+		const auto state = d.vintermediate_state();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			auto &s = state.c_updates_state();
+			setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
 
-		auto &s = d.vintermediate_state().c_updates_state();
-		setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
-
-		_ptsWaiter.setRequesting(false);
+			_ptsWaiter.setRequesting(false);
 
-		MTP_LOG(0, ("getDifference "
-			"{ good - after a slice of difference was received }%1"
-			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
-		getDifference();
+			MTP_LOG(0, ("getDifference "
+				"{ good - after a slice of difference was received }%1"
+				).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
+			getDifference();
+		});
 	} break;
 	case mtpc_updates_difference: {
 		auto &d = result.c_updates_difference();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		stateDone(d.vstate());
+		const auto state = d.vstate();
+		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates(), [=] {
+			stateDone(state);
+		});
 	} break;
 	case mtpc_updates_differenceTooLong: {
 		LOG(("API Error: updates.differenceTooLong is not supported by Telegram Desktop!"));
@@ -583,17 +660,87 @@ bool Updates::updateAndApply(int32 pts, int32 ptsCount) {
 	return _ptsWaiter.updateAndApply(nullptr, pts, ptsCount);
 }
 
+struct Updates::PreparedDifference {
+	QVector<MTPUser> users;
+	QVector<MTPChat> chats;
+	QVector<MTPMessage> messages;
+	MTPVector<MTPUpdate> other;
+	int processed = 0;
+};
+
 void Updates::feedDifference(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other) {
+		const MTPVector<MTPUpdate> &other,
+		Fn<void()> done) {
 	Core::App().checkAutoLock();
-	session().data().processUsers(users);
-	session().data().processChats(chats);
-	feedMessageIds(other);
-	session().data().processMessages(msgs, NewMessageType::Unread);
-	feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+	const auto size = users.v.size() + chats.v.size() + msgs.v.size();
+	if (size < kDifferencePrepareThreshold) {
+		session().data().processUsers(users);
+		session().data().processChats(chats);
+		feedMessageIds(other);
+		session().data().processMessages(msgs, NewMessageType::Unread);
+		feedUpdateVector(other, SkipUpdatePolicy::SkipMessageIds);
+		done();
+		return;
+	}
+
+	// No other getDifference is sent until done() is called,
+	// even if the failed difference timer fires while we're applying.
+	_applyingDifference = true;
+	const auto weak = base::make_weak(&session());
+	crl::async([=] {
+		auto prepared = std::make_shared<PreparedDifference>(
+			PreparedDifference{
+				.users = DeduplicatedUsers(users.v),
+				.chats = DeduplicatedChats(chats.v),
+				.messages = SortedById(msgs.v),
+				.other = other,
+			});
+		crl::on_main(weak, [=]() mutable {
+			feedPreparedDifference(std::move(prepared), std::move(done));
+		});
+	});
+}
+
+void Updates::feedPreparedDifference(
+		std::shared_ptr<PreparedDifference> prepared,
+		Fn<void()> done) {
+	session().data().processUsers(MTP_vector<MTPUser>(
+		base::take(prepared->users)));
+	session().data().processChats(MTP_vector<MTPChat>(
+		base::take(prepared->chats)));
+	feedMessageIds(prepared->other);
+	feedPreparedDifferenceMessages(std::move(prepared), std::move(done));
+}
+
+void Updates::feedPreparedDifferenceMessages(
+		std::shared_ptr<PreparedDifference> prepared,
+		Fn<void()> done) {
+	const auto &messages = prepared->messages;
+	const auto till = crl::now() + kDifferenceSliceDuration;
+	while (prepared->processed < messages.size()) {
+		const auto count = std::min(
+			kDifferenceMessagesChunk,
+			int(messages.size()) - prepared->processed);
+		session().data().processMessages(
+			messages.mid(prepared->processed, count),
+			NewMessageType::Unread);
+		prepared->processed += count;
+		if (prepared->processed < messages.size() && crl::now() >= till) {
+			session().data().sendHistoryChangeNotifications();
+			crl::on_main(&session(), [=]() mutable {
+				feedPreparedDifferenceMessages(
+					std::move(prepared),
+					std::move(done));
+			});
+			return;
+		}
+	}
+	feedUpdateVector(prepared->other, SkipUpdatePolicy::SkipMessageIds);
+	_applyingDifference = false;
+	done();
 }
 
 void Updates::differenceFail(const MTP::Error &error) {
@@ -636,6 +783,9 @@ void Updates::getDifferenceAfterFail() {
 	if (_getDifferenceTimeAfterFail) {
 		if (_getDifferenceTimeAfterFail > now) {
 			wait = _getDifferenceTimeAfterFail - now;
+		} else if (_applyingDifference) {
+			// The difference being applied brings the state up to date.
+			_getDifferenceTimeAfterFail = 0;
 		} else {
 			_ptsWaiter.setRequesting(false);
 			MTP_LOG(0, ("getDifference "
@@ -663,7 +813,7 @@ void Updates::getDifferenceAfterFail() {
 void Updates::getDifference() {
 	_getDifferenceTimeByPts = 0;
 
-	if (requestingDifference()) {
+	if (requestingDifference() || _applyingDifference) {
 		return;
 	}
 
@@ -82,6 +82,8 @@ private:
 		rpl::lifetime lifetime;
 	};
 
+	struct PreparedDifference;
+
 	void channelRangeDifferenceSend(
 		not_null<ChannelData*> channel,
 		MsgRange range,
@@ -108,7 +110,14 @@ private:
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other);
+		const MTPVector<MTPUpdate> &other,
+		Fn<void()> done);
+	void feedPreparedDifference(
+		std::shared_ptr<PreparedDifference> prepared,
+		Fn<void()> done);
+	void feedPreparedDifferenceMessages(
+		std::shared_ptr<PreparedDifference> prepared,
+		Fn<void()> done);
 	void stateDone(const MTPupdates_State &state);
 	void setState(int32 pts, int32 date, int32 qts, int32 seq);
 	void channelDifferenceDone(
@@ -168,6 +177,7 @@ private:
 	base::Timer _onlineTimer;
 
 	PtsWaiter _ptsWaiter;
+	bool _applyingDifference = false;
 
 	base::flat_map<not_null<ChannelData*>, crl::time> _whenGetDiffByPts;
 	base::flat_map<not_null<ChannelData*>, crl::time> _whenGetDiffAfterFail;
@@ -134,6 +134,29 @@ using UpdatedFileReferences = Data::UpdatedFileReferences;
 	return nullptr;
 }
 
+template <typename Type>
+[[nodiscard]] QByteArray SerializeObject(const Type &object) {
+	auto buffer = mtpBuffer();
+	buffer.reserve(tl::count_length(object) / sizeof(mtpPrime));
+	object.write(buffer);
+	return QByteArray(
+		reinterpret_cast<const char*>(buffer.constData()),
+		buffer.size() * sizeof(mtpPrime));
+}
+
+template <typename Type>
+[[nodiscard]] std::optional<Type> DeserializeObject(const QByteArray &data) {
+	if (data.isEmpty() || (data.size() % sizeof(mtpPrime))) {
+		return std::nullopt;
+	}
+	auto result = Type();
+	auto from = reinterpret_cast<const mtpPrime*>(data.constData());
+	const auto till = from + (data.size() / sizeof(mtpPrime));
+	return result.read(from, till)
+		? std::make_optional(std::move(result))
+		: std::nullopt;
+}
+
 void ShowChannelsLimitBox(not_null<PeerData*> peer) {
 	if (const auto window = Core::App().windowFor(peer)) {
 		window->invokeForSessionController(
@@ -826,6 +849,106 @@ void ApiWrap::requestContacts() {
 	}).send();
 }
 
+void ApiWrap::applyDialogsSnapshot() {
+	const auto serialized = local().readDialogsSnapshot();
+	if (serialized.isEmpty()) {
+		return;
+	}
+	auto pinned = QByteArray();
+	auto list = QByteArray();
+	{
+		QDataStream stream(serialized);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream >> pinned >> list;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("API Error: bad dialogs snapshot."));
+			return;
+		}
+	}
+	const auto pinnedDialogs = DeserializeObject<MTPmessages_PeerDialogs>(
+		pinned);
+	const auto listDialogs = DeserializeObject<MTPmessages_Dialogs>(list);
+	if (!pinnedDialogs || !listDialogs) {
+		LOG(("API Error: could not parse dialogs snapshot."));
+		return;
+	}
+
+	// Show the chats list right away, the requests that follow
+	// after the updates state is received will bring it up to date.
+	auto &owner = _session->data();
+	const auto rememberHistories = [&](const QVector<MTPDialog> &dialogs) {
+		for (const auto &dialog : dialogs) {
+			dialog.match([&](const MTPDdialog &data) {
+				_dialogsSnapshotUnconfirmed.emplace(
+					owner.history(peerFromMTP(data.vpeer())));
+			}, [](const MTPDdialogFolder &) {
+			});
+		}
+	};
+	pinnedDialogs->match([&](const MTPDmessages_peerDialogs &data) {
+		owner.processUsers(data.vusers());
+		owner.processChats(data.vchats());
+		owner.applyDialogs(nullptr, data.vmessages().v, data.vdialogs().v);
+		rememberHistories(data.vdialogs().v);
+	});
+	listDialogs->match([](const MTPDmessages_dialogsNotModified &) {
+	}, [&](const auto &data) {
+		owner.processUsers(data.vusers());
+		owner.processChats(data.vchats());
+		owner.applyDialogs(nullptr, data.vmessages().v, data.vdialogs().v);
+		rememberHistories(data.vdialogs().v);
+	});
+	owner.chatsListChanged(nullptr);
+	owner.notifyPinnedDialogsOrderUpdated();
+}
+
+void ApiWrap::confirmDialogsSnapshot(
+		const QVector<MTPDialog> &dialogs,
+		bool pinned) {
+	if (_dialogsSnapshotUnconfirmed.empty()) {
+		return;
+	}
+	for (const auto &dialog : dialogs) {
+		dialog.match([&](const MTPDdialog &data) {
+			const auto peerId = peerFromMTP(data.vpeer());
+			if (const auto history = _session->data().historyLoaded(peerId)) {
+				_dialogsSnapshotUnconfirmed.remove(history);
+			}
+		}, [](const MTPDdialogFolder &) {
+		});
+	}
+	if (pinned) {
+		_dialogsSnapshotPinnedReceived = true;
+	} else {
+		_dialogsSnapshotListReceived = true;
+	}
+	if (!_dialogsSnapshotPinnedReceived || !_dialogsSnapshotListReceived) {
+		return;
+	}
+
+	// Chats from the snapshot that the server didn't list could be left,
+	// deleted or moved since then, so request their actual dialog entries.
+	auto &histories = _session->data().histories();
+	for (const auto &history : base::take(_dialogsSnapshotUnconfirmed)) {
+		histories.requestDialogEntry(history);
+	}
+}
+
+void ApiWrap::writeDialogsSnapshot() {
+	if (_dialogsSnapshotPinned.isEmpty() || _dialogsSnapshotList.isEmpty()) {
+		return;
+	}
+	auto serialized = QByteArray();
+	{
+		QDataStream stream(&serialized, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream
+			<< base::take(_dialogsSnapshotPinned)
+			<< base::take(_dialogsSnapshotList);
+	}
+	local().writeDialogsSnapshot(serialized);
+}
+
 void ApiWrap::requestDialogs(Data::Folder *folder) {
 	if (folder && !_foldersLoadState.contains(folder)) {
 		_foldersLoadState.emplace(folder, DialogsLoadState());
@@ -893,6 +1016,14 @@ void ApiWrap::requestMoreDialogs(Data::Folder *folder) {
 			&& (!_dialogsLoadState || !_dialogsLoadState->listReceived)) {
 			refreshDialogsLoadBlocked();
 		}
+		if (!folder && firstLoad) {
+			result.match([](const MTPDmessages_dialogsNotModified &) {
+			}, [&](const auto &data) {
+				confirmDialogsSnapshot(data.vdialogs().v, false);
+			});
+			_dialogsSnapshotList = SerializeObject(result);
+			writeDialogsSnapshot();
+		}
 		requestMoreDialogsIfNeeded();
 		_session->data().chatsListChanged(folder);
 	}).fail([=] {
@@ -1040,6 +1171,13 @@ void ApiWrap::requestPinnedDialogs(Data::Folder *folder) {
 			_session->data().chatsListChanged(folder);
 			_session->data().notifyPinnedDialogsOrderUpdated();
 		});
+		if (!folder) {
+			result.match([&](const MTPDmessages_peerDialogs &data) {
+				confirmDialogsSnapshot(data.vdialogs().v, true);
+			});
+			_dialogsSnapshotPinned = SerializeObject(result);
+			writeDialogsSnapshot();
+		}
 	}).fail([=] {
 		finalize();
 	}).send();
@@ -164,6 +164,7 @@ public:
 	QString exportDirectStoryLink(not_null<Data::Story*> item);
 
 	void requestContacts();
+	void applyDialogsSnapshot();
 	void requestDialogs(Data::Folder *folder = nullptr);
 	void requestPinnedDialogs(Data::Folder *folder = nullptr);
 	void requestMoreBlockedByDateDialogs();
@@ -424,6 +425,10 @@ private:
 	void requestMoreDialogs(Data::Folder *folder);
 	DialogsLoadState *dialogsLoadState(Data::Folder *folder);
 	void dialogsLoadFinish(Data::Folder *folder);
+	void confirmDialogsSnapshot(
+		const QVector<MTPDialog> &dialogs,
+		bool pinned);
+	void writeDialogsSnapshot();
 
 	void checkQuitPreventFinished();
 
@@ -628,6 +633,11 @@ private:
 	TimeId _dialogsLoadTill = 0;
 	rpl::variable<bool> _dialogsLoadMayBlockByDate = false;
 	rpl::variable<bool> _dialogsLoadBlockedByDate = false;
+	QByteArray _dialogsSnapshotPinned;
+	QByteArray _dialogsSnapshotList;
+	base::flat_set<not_null<History*>> _dialogsSnapshotUnconfirmed;
+	bool _dialogsSnapshotPinnedReceived = false;
+	bool _dialogsSnapshotListReceived = false;
 
 	base::flat_map<
 		not_null<Data::Folder*>,
@@ -1065,6 +1065,50 @@ void PeerListContent::addToSearchIndex(not_null<PeerListRow*> row) {
 	for (auto ch : row->nameFirstLetters()) {
 		_searchIndex[ch].push_back(row);
 	}
+	_searchIndexChanged = true;
+}
+
+bool PeerListContent::RowMatchesSearchWords(
+		not_null<PeerListRow*> row,
+		const QStringList &searchWords) {
+	// Name words are sorted, so the only candidate for a prefix match
+	// is the first word that is not less than the search word.
+	const auto &nameWords = row->generateNameWords();
+	for (const auto &searchWord : searchWords) {
+		const auto i = nameWords.lower_bound(searchWord);
+		if (i == nameWords.end() || !i->startsWith(searchWord)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+auto PeerListContent::refinedSearchResults(
+	const QStringList &searchWords) const
+-> std::optional<std::vector<not_null<PeerListRow*>>> {
+	// While the query only grows we filter the previous local results
+	// instead of going through the whole first letter index again.
+	if (_searchIndexChanged || _normalizedSearchQuery.isEmpty()) {
+		return std::nullopt;
+	}
+	const auto was = _normalizedSearchQuery.split(' ', Qt::SkipEmptyParts);
+	for (const auto &wasWord : was) {
+		const auto refined = ranges::any_of(searchWords, [&](
+				const QString &searchWord) {
+			return searchWord.startsWith(wasWord);
+		});
+		if (!refined) {
+			return std::nullopt;
+		}
+	}
+	auto result = std::vector<not_null<PeerListRow*>>();
+	result.reserve(_filterResults.size());
+	for (const auto &row : _filterResults) {
+		if (!row->isSearchResult() && RowMatchesSearchWords(row, searchWords)) {
+			result.push_back(row);
+		}
+	}
+	return result;
 }
 
 void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
@@ -1912,49 +1956,20 @@ void PeerListContent::searchQueryChanged(QString query) {
 	const auto searchWordsList = TextUtilities::PrepareSearchWords(query);
 	const auto normalizedQuery = searchWordsList.join(' ');
 	if (_normalizedSearchQuery != normalizedQuery) {
+		const auto searchInLocal = _controller->searchInLocal()
+			&& !searchWordsList.isEmpty();
+		auto refined = searchInLocal
+			? refinedSearchResults(searchWordsList)
+			: std::nullopt;
 		setSearchQuery(query, normalizedQuery);
-		if (_controller->searchInLocal() && !searchWordsList.isEmpty()) {
+		if (searchInLocal) {
 			Assert(_hiddenRows.empty());
 
-			auto minimalList = (const std::vector<not_null<PeerListRow*>>*)nullptr;
-			for (const auto &searchWord : searchWordsList) {
-				auto searchWordStart = searchWord[0].toLower();
-				auto it = _searchIndex.find(searchWordStart);
-				if (it == _searchIndex.cend()) {
-					// Some word can't be found in any row.
-					minimalList = nullptr;
-					break;
-				} else if (!minimalList || minimalList->size() > it->second.size()) {
-					minimalList = &it->second;
-				}
-			}
-			if (minimalList) {
-				auto searchWordInNames = [](
-						not_null<PeerListRow*> row,
-						const QString &searchWord) {
-					for (auto &nameWord : row->generateNameWords()) {
-						if (nameWord.startsWith(searchWord)) {
-							return true;
-						}
-					}
-					return false;
-				};
-				auto allSearchWordsInNames = [&](
-						not_null<PeerListRow*> row) {
-					for (const auto &searchWord : searchWordsList) {
-						if (!searchWordInNames(row, searchWord)) {
-							return false;
-						}
-					}
-					return true;
-				};
-
-				_filterResults.reserve(minimalList->size());
-				for (const auto &row : *minimalList) {
-					if (allSearchWordsInNames(row)) {
-						_filterResults.push_back(row);
-					}
-				}
+			_searchIndexChanged = false;
+			if (refined) {
+				_filterResults = std::move(*refined);
+			} else {
+				searchInIndex(searchWordsList);
 			}
 		}
 		if (_controller->hasComplexSearch()) {
@@ -1964,6 +1979,28 @@ void PeerListContent::searchQueryChanged(QString query) {
 	}
 }
 
+void PeerListContent::searchInIndex(const QStringList &searchWords) {
+	auto minimalList = (const std::vector<not_null<PeerListRow*>>*)nullptr;
+	for (const auto &searchWord : searchWords) {
+		auto searchWordStart = searchWord[0].toLower();
+		auto it = _searchIndex.find(searchWordStart);
+		if (it == _searchIndex.cend()) {
+			// Some word can't be found in any row.
+			return;
+		} else if (!minimalList || minimalList->size() > it->second.size()) {
+			minimalList = &it->second;
+		}
+	}
+	if (minimalList) {
+		_filterResults.reserve(minimalList->size());
+		for (const auto &row : *minimalList) {
+			if (RowMatchesSearchWords(row, searchWords)) {
+				_filterResults.push_back(row);
+			}
+		}
+	}
+}
+
 std::unique_ptr<PeerListState> PeerListContent::saveState() const {
 	Expects(_hiddenRows.empty());
 
@@ -770,6 +770,13 @@ private:
 	void addRowEntry(not_null<PeerListRow*> row);
 	void addToSearchIndex(not_null<PeerListRow*> row);
 	bool addingToSearchIndex() const;
+	void searchInIndex(const QStringList &searchWords);
+	[[nodiscard]] static bool RowMatchesSearchWords(
+		not_null<PeerListRow*> row,
+		const QStringList &searchWords);
+	[[nodiscard]] auto refinedSearchResults(
+		const QStringList &searchWords) const
+	-> std::optional<std::vector<not_null<PeerListRow*>>>;
 	void removeFromSearchIndex(not_null<PeerListRow*> row);
 	void setSearchQuery(const QString &query, const QString &normalizedQuery);
 	bool showingSearch() const {
@@ -816,6 +823,7 @@ private:
 	std::map<PeerData*, std::vector<not_null<PeerListRow*>>> _rowsByPeer;
 
 	std::map<QChar, std::vector<not_null<PeerListRow*>>> _searchIndex;
+	bool _searchIndexChanged = false;
 	QString _searchQuery;
 	QString _normalizedSearchQuery;
 	QString _mentionHighlight;
@@ -38,10 +38,21 @@ struct LangPackEmoji {
 	QString text;
 };
 
+// Sorted keys with all their emoji laid out in a single array,
+// prefix queries are a binary search and a linear walk over it.
+struct LangPackIndex {
+	std::vector<QString> keys;
+	std::vector<int> offsets;
+	std::vector<LangPackEmoji> emoji;
+};
+
+// The keyword map is used only while reading or updating the data
+// on a worker thread, it is moved into the index after that.
 struct LangPackData {
 	int version = 0;
 	int maxKeyLength = 0;
 	std::map<QString, std::vector<LangPackEmoji>> emoji;
+	LangPackIndex index;
 };
 
 [[nodiscard]] bool MustAddPostfix(const QString &text) {
@@ -94,6 +105,43 @@ void CreateCacheFilePath() {
 	return internal::CacheFileFolder() + u"/keywords/"_q + id;
 }
 
+void FillIndex(LangPackData &data) {
+	auto &index = data.index;
+	index = LangPackIndex();
+	index.keys.reserve(data.emoji.size());
+	index.offsets.reserve(data.emoji.size() + 1);
+	auto count = 0;
+	for (const auto &[key, list] : data.emoji) {
+		count += int(list.size());
+	}
+	index.emoji.reserve(count);
+	for (auto &[key, list] : base::take(data.emoji)) {
+		index.keys.push_back(key);
+		index.offsets.push_back(int(index.emoji.size()));
+		index.emoji.insert(
+			end(index.emoji),
+			std::make_move_iterator(begin(list)),
+			std::make_move_iterator(end(list)));
+	}
+	index.offsets.push_back(int(index.emoji.size()));
+}
+
+void FillMap(LangPackData &data) {
+	auto index = base::take(data.index);
+	const auto emoji = gsl::make_span(index.emoji);
+	for (auto i = 0, count = int(index.keys.size()); i != count; ++i) {
+		const auto offset = index.offsets[i];
+		const auto list = emoji.subspan(
+			offset,
+			index.offsets[i + 1] - offset);
+		data.emoji.emplace(
+			std::move(index.keys[i]),
+			std::vector<LangPackEmoji>(
+				std::make_move_iterator(list.begin()),
+				std::make_move_iterator(list.end())));
+	}
+}
+
 [[nodiscard]] LangPackData ReadLocalCache(const QString &id) {
 	auto file = QFile(CacheFilePath(id));
 	if (!file.open(QIODevice::ReadOnly)) {
@@ -138,11 +186,13 @@ void CreateCacheFilePath() {
 		result.maxKeyLength = std::max(result.maxKeyLength, int(key.size()));
 	}
 	result.version = version;
+	FillIndex(result);
 	return result;
 }
 
 void WriteLocalCache(const QString &id, const LangPackData &data) {
-	if (!data.version && data.emoji.empty()) {
+	const auto &index = data.index;
+	if (!data.version && index.keys.empty()) {
 		return;
 	}
 	CreateCacheFilePath();
@@ -154,13 +204,15 @@ void WriteLocalCache(const QString &id, const LangPackData &data) {
 	stream.setVersion(QDataStream::Qt_5_1);
 	stream
 		<< qint32(data.version)
-		<< qint32(data.emoji.size());
-	for (const auto &[key, list] : data.emoji) {
+		<< qint32(index.keys.size());
+	for (auto i = 0, count = int(index.keys.size()); i != count; ++i) {
+		const auto from = index.offsets[i];
+		const auto till = index.offsets[i + 1];
 		stream
-			<< key
-			<< qint32(list.size());
-		for (const auto &emoji : list) {
-			stream << emoji.text;
+			<< index.keys[i]
+			<< qint32(till - from);
+		for (auto j = from; j != till; ++j) {
+			stream << index.emoji[j].text;
 		}
 	}
 }
@@ -175,26 +227,14 @@ void WriteLocalCache(const QString &id, const LangPackData &data) {
 
 void AppendFoundEmoji(
 		std::vector<Result> &result,
+		std::unordered_set<EmojiPtr> &already,
 		const QString &label,
-		const std::vector<LangPackEmoji> &list) {
-	// It is important that the 'result' won't relocate while inserting.
-	result.reserve(result.size() + list.size());
-	const auto alreadyBegin = begin(result);
-	const auto alreadyEnd = alreadyBegin + result.size();
-
-	auto &&add = ranges::views::all(
-		list
-	) | ranges::views::filter([&](const LangPackEmoji &entry) {
-		const auto i = ranges::find(
-			alreadyBegin,
-			alreadyEnd,
-			entry.emoji,
-			&Result::emoji);
-		return (i == alreadyEnd);
-	}) | ranges::views::transform([&](const LangPackEmoji &entry) {
-		return Result{ entry.emoji, label, entry.text };
-	});
-	result.insert(end(result), add.begin(), add.end());
+		gsl::span<const LangPackEmoji> list) {
+	for (const auto &entry : list) {
+		if (already.emplace(entry.emoji).second) {
+			result.push_back({ entry.emoji, label, entry.text });
+		}
+	}
 }
 
 void AppendLegacySuggestions(
@@ -245,6 +285,7 @@ void ApplyDifference(
 		LangPackData &data,
 		const QVector<MTPEmojiKeyword> &keywords,
 		int version) {
+	FillMap(data);
 	data.version = version;
 	for (const auto &keyword : keywords) {
 		keyword.match([&](const MTPDemojiKeyword &keyword) {
@@ -301,6 +342,7 @@ void ApplyDifference(
 		});
 		data.maxKeyLength = *ranges::max_element(lengths);
 	}
+	FillIndex(data);
 }
 
 } // namespace
@@ -433,19 +475,20 @@ void EmojiKeywords::LangPack::applyDifference(
 			_state = State::Refreshed;
 			return;
 		}
+		// The pack stays usable until the updated copy is ready,
+		// copying the index only shares the key and emoji strings.
 		const auto id = _id;
-		auto copy = _data;
 		auto callback = crl::guard(_guard.make_guard(), [=](
 				LangPackData &&result) {
 			applyData(std::move(result));
 		});
 		crl::async([=,
-			copy = std::move(copy),
+			pack = _data,
 			callback = std::move(callback)]() mutable {
-			ApplyDifference(copy, keywords, version);
-			WriteLocalCache(id, copy);
+			ApplyDifference(pack, keywords, version);
+			WriteLocalCache(id, pack);
 			crl::on_main([
-				result = std::move(copy),
+				result = std::move(pack),
 				callback = std::move(callback)
 			]() mutable {
 				callback(std::move(result));
@@ -474,23 +517,30 @@ std::vector<Result> EmojiKeywords::LangPack::query(
 		const QString &normalized,
 		bool exact) const {
 	if (normalized.size() > _data.maxKeyLength
-		|| _data.emoji.empty()
+		|| _data.index.keys.empty()
 		|| (exact && SkipExactKeyword(_id, normalized))) {
 		return {};
 	}
 
-	const auto from = _data.emoji.lower_bound(normalized);
-	auto &&chosen = ranges::make_subrange(
-		from,
-		end(_data.emoji)
-	) | ranges::views::take_while([&](const auto &pair) {
-		const auto &key = pair.first;
-		return exact ? (key == normalized) : key.startsWith(normalized);
-	});
-
+	// Keys with the query as a prefix follow each other after the
+	// lower bound, and the exact match, if any, comes first.
+	const auto &index = _data.index;
+	const auto from = ranges::lower_bound(index.keys, normalized);
 	auto result = std::vector<Result>();
-	for (const auto &[key, list] : chosen) {
-		AppendFoundEmoji(result, key, list);
+	auto already = std::unordered_set<EmojiPtr>();
+	const auto emoji = gsl::make_span(index.emoji);
+	for (auto i = from; i != end(index.keys); ++i) {
+		const auto &key = *i;
+		if (exact ? (key != normalized) : !key.startsWith(normalized)) {
+			break;
+		}
+		const auto position = int(i - begin(index.keys));
+		const auto offset = index.offsets[position];
+		AppendFoundEmoji(
+			result,
+			already,
+			key,
+			emoji.subspan(offset, index.offsets[position + 1] - offset));
 	}
 	return result;
 }
@@ -613,27 +663,24 @@ std::vector<Result> EmojiKeywords::query(
 		return {};
 	}
 	auto result = std::vector<Result>();
+	auto already = std::unordered_set<EmojiPtr>();
 	for (const auto &[language, item] : _data) {
-		const auto list = item->query(normalized, exact);
-
-		// It is important that the 'result' won't relocate while inserting.
-		result.reserve(result.size() + list.size());
-		const auto alreadyBegin = begin(result);
-		const auto alreadyEnd = alreadyBegin + result.size();
-
-		auto &&add = ranges::views::all(
-			list
-		) | ranges::views::filter([&](Result entry) {
+		auto list = item->query(normalized, exact);
+		if (result.empty()) {
 			// In each item->query() result the list has no duplicates.
 			// So we need to check only for duplicates between queries.
-			const auto i = ranges::find(
-				alreadyBegin,
-				alreadyEnd,
-				entry.emoji,
-				&Result::emoji);
-			return (i == alreadyEnd);
-		});
-		result.insert(end(result), add.begin(), add.end());
+			for (const auto &entry : list) {
+				already.emplace(entry.emoji);
+			}
+			result = std::move(list);
+			continue;
+		}
+		result.reserve(result.size() + list.size());
+		for (auto &entry : list) {
+			if (already.emplace(entry.emoji).second) {
+				result.push_back(std::move(entry));
+			}
+		}
 	}
 	if (!exact) {
 		AppendLegacySuggestions(result, query);
@@ -480,6 +480,7 @@ void DocumentData::setDataAndCache(const QByteArray &data) {
 			Storage::Cache::Database::TaggedValue(
 				base::duplicate(data),
 				cacheTag()));
+		owner().documentCached(this, data.size());
 	}
 }
 
@@ -781,6 +782,12 @@ void DocumentData::finishLoad() {
 	}
 	setLocation(Core::FileLocation(_loader->fileName()));
 	setGoodThumbnailDataReady();
+	const auto &bytes = _loader->bytes();
+	if (saveToCache()
+		&& !bytes.isEmpty()
+		&& bytes.size() <= Storage::kMaxFileInMemory) {
+		_owner->documentCached(this, bytes.size());
+	}
 	if (const auto media = activeMediaView()) {
 		media->setBytes(_loader->bytes());
 		media->checkStickerLarge(_loader.get());
@@ -0,0 +1,149 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_messages_index.h"
+
+#include "history/history.h"
+#include "history/history_item.h"
+#include "ui/text/text_utilities.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kMaxIndexedLength = 4096;
+
+[[nodiscard]] QStringList ItemWords(not_null<HistoryItem*> item) {
+	if (!item->isRegular()) {
+		return {};
+	}
+	const auto &text = item->originalText().text;
+	auto result = TextUtilities::PrepareSearchWords(
+		(text.size() > kMaxIndexedLength)
+			? text.mid(0, kMaxIndexedLength)
+			: text);
+	result.removeDuplicates();
+	return result;
+}
+
+} // namespace
+
+MessagesIndex::MessagesIndex() = default;
+
+MessagesIndex::~MessagesIndex() = default;
+
+void MessagesIndex::add(not_null<HistoryItem*> item) {
+	auto words = ItemWords(item);
+	if (words.isEmpty()) {
+		return;
+	}
+	for (const auto &word : words) {
+		_items[word].emplace(item);
+	}
+	_words.emplace(item, std::move(words));
+}
+
+void MessagesIndex::update(not_null<HistoryItem*> item) {
+	remove(item);
+	add(item);
+}
+
+void MessagesIndex::remove(not_null<HistoryItem*> item) {
+	const auto i = _words.find(item);
+	if (i == end(_words)) {
+		return;
+	}
+	for (const auto &word : i->second) {
+		const auto j = _items.find(word);
+		if (j != end(_items)) {
+			j->second.erase(item);
+			if (j->second.empty()) {
+				_items.erase(j);
+			}
+		}
+	}
+	_words.erase(i);
+}
+
+auto MessagesIndex::collect(const QString &prefix) const -> Items {
+	auto result = Items();
+	for (auto i = _items.lower_bound(prefix); i != end(_items); ++i) {
+		if (!i->first.startsWith(prefix)) {
+			break;
+		} else if (result.empty()) {
+			result = i->second;
+		} else {
+			for (const auto item : i->second) {
+				result.emplace(item);
+			}
+		}
+	}
+	return result;
+}
+
+bool MessagesIndex::matches(
+		not_null<HistoryItem*> item,
+		const Query &query) const {
+	const auto history = item->history();
+	if (query.inHistory) {
+		if (history != query.inHistory) {
+			return false;
+		} else if (query.topicRootId
+			&& item->topicRootId() != query.topicRootId) {
+			return false;
+		}
+	} else if (query.skipArchive && history->folder()) {
+		return false;
+	}
+	return !query.from || (item->from() == query.from);
+}
+
+std::vector<not_null<HistoryItem*>> MessagesIndex::search(
+		const Query &query) const {
+	auto words = TextUtilities::PrepareSearchWords(query.text);
+	if (words.isEmpty() || _items.empty()) {
+		return {};
+	}
+
+	// Start from the longest word, it usually has the fewest matches.
+	ranges::sort(words, ranges::greater(), &QString::size);
+	auto found = collect(words.front());
+	for (auto i = 1; i != words.size() && !found.empty(); ++i) {
+		const auto &word = words[i];
+		auto filtered = Items();
+		for (const auto item : found) {
+			const auto &list = _words.find(item)->second;
+			const auto has = ranges::any_of(list, [&](const QString &indexed) {
+				return indexed.startsWith(word);
+			});
+			if (has) {
+				filtered.emplace(item);
+			}
+		}
+		found = std::move(filtered);
+	}
+
+	auto result = std::vector<not_null<HistoryItem*>>();
+	result.reserve(found.size());
+	for (const auto item : found) {
+		if (matches(item, query)) {
+			result.push_back(item);
+		}
+	}
+	const auto later = [](not_null<HistoryItem*> a, not_null<HistoryItem*> b) {
+		return (a->date() > b->date())
+			|| (a->date() == b->date() && a->id > b->id);
+	};
+	if (query.limit > 0 && int(result.size()) > query.limit) {
+		ranges::partial_sort(result, begin(result) + query.limit, later);
+		result.resize(query.limit);
+	} else {
+		ranges::sort(result, later);
+	}
+	return result;
+}
+
+} // namespace Data
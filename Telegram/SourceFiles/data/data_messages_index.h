@@ -0,0 +1,54 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class History;
+class HistoryItem;
+class PeerData;
+
+namespace Data {
+
+// In-memory inverted index of the texts of loaded messages,
+// used to show search results before the server answers.
+class MessagesIndex final {
+public:
+	struct Query {
+		QString text;
+		History *inHistory = nullptr;
+		MsgId topicRootId = 0;
+		PeerData *from = nullptr;
+		bool skipArchive = false;
+		int limit = 0;
+	};
+
+	MessagesIndex();
+	~MessagesIndex();
+
+	void add(not_null<HistoryItem*> item);
+	void update(not_null<HistoryItem*> item);
+	void remove(not_null<HistoryItem*> item);
+
+	[[nodiscard]] std::vector<not_null<HistoryItem*>> search(
+		const Query &query) const;
+
+private:
+	// Items are added one by one while histories load,
+	// so the per-word sets and the words map are hashed.
+	using Items = std::unordered_set<not_null<HistoryItem*>>;
+
+	[[nodiscard]] Items collect(const QString &prefix) const;
+	[[nodiscard]] bool matches(
+		not_null<HistoryItem*> item,
+		const Query &query) const;
+
+	std::map<QString, Items> _items;
+	std::unordered_map<not_null<HistoryItem*>, QStringList> _words;
+
+};
+
+} // namespace Data
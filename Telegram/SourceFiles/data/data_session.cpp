@@ -67,6 +67,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_forum_icons.h"
 #include "data/data_cloud_themes.h"
 #include "data/data_stories.h"
+#include "data/data_messages_index.h"
 #include "data/data_story.h"
 #include "data/data_streaming.h"
 #include "data/data_media_rotation.h"
@@ -87,6 +88,14 @@ namespace {
 
 using ViewElement = HistoryView::Element;
 
+constexpr auto kPeersLocalCacheLimit = 1000;
+
+// Video messages and animations may take only a part of the cache,
+// otherwise they push images and stickers out of it.
+constexpr auto kCacheTagQuotaDivider = 3;
+constexpr auto kCacheQuotaCheckTimeout = 10 * crl::time(1000);
+constexpr auto kCacheQuotaIdleTimeout = 60 * crl::time(1000);
+
 // s: box 100x100
 // m: box 320x320
 // x: box 800x800
@@ -254,6 +263,7 @@ Session::Session(not_null<Main::Session*> session)
 , _selfDestructTimer([=] { checkSelfDestructItems(); })
 , _pollsClosingTimer([=] { checkPollsClosings(); })
 , _watchForOfflineTimer([=] { checkLocalUsersWentOffline(); })
+, _cacheQuotaTimer([=] { enforceCacheQuotas(); })
 , _groups(this)
 , _chatsFilters(std::make_unique<ChatFilters>(this))
 , _scheduledMessages(std::make_unique<ScheduledMessages>(this))
@@ -269,7 +279,8 @@ Session::Session(not_null<Main::Session*> session)
 , _forumIcons(std::make_unique<ForumIcons>(this))
 , _notifySettings(std::make_unique<NotifySettings>(this))
 , _customEmojiManager(std::make_unique<CustomEmojiManager>(this))
-, _stories(std::make_unique<Stories>(this)) {
+, _stories(std::make_unique<Stories>(this))
+, _messagesIndex(std::make_unique<MessagesIndex>()) {
 	_cache->open(_session->local().cacheKey());
 	_bigFileCache->open(_session->local().cacheBigFileKey());
 
@@ -285,6 +296,7 @@ Session::Session(not_null<Main::Session*> session)
 	setupChannelLeavingViewer();
 	setupPeerNameViewer();
 	setupUserIsContactViewer();
+	setupCacheQuotas();
 
 	_chatsList.unreadStateChanges(
 	) | rpl::start_with_next([=] {
@@ -1082,6 +1094,86 @@ void Session::maybeStopWatchForOffline(not_null<UserData*> user) {
 	}
 }
 
+void Session::setupCacheQuotas() {
+	_cache->statsOnMain(
+	) | rpl::start_with_next([=](
+			const Storage::Cache::Database::Stats &stats) {
+		_cacheOverQuota.clear();
+		if (stats.clearing) {
+			return;
+		}
+		const auto quota = _session->local().cacheSettings().totalSizeLimit
+			/ kCacheTagQuotaDivider;
+		for (const auto tag : { kVideoMessageCacheTag, kAnimationCacheTag }) {
+			const auto i = stats.tagged.find(tag);
+			if (i != end(stats.tagged) && i->second.totalSize > quota) {
+				_cacheOverQuota.emplace(tag, i->second.totalSize - quota);
+			}
+		}
+		if (!_cacheOverQuota.empty() && !_cacheQuotaTimer.isActive()) {
+			_cacheQuotaTimer.callOnce(kCacheQuotaCheckTimeout);
+		}
+	}, _lifetime);
+}
+
+bool Session::mediaPlaying() const {
+	const auto player = ::Media::Player::instance();
+	using Type = AudioMsgId::Type;
+	for (const auto type : { Type::Voice, Type::Song }) {
+		if (!IsStoppedOrStopping(player->getState(type).state)) {
+			return true;
+		}
+	}
+	return _streaming->hasActiveReaders();
+}
+
+void Session::enforceCacheQuotas() {
+	if (_cacheOverQuota.empty()) {
+		return;
+	}
+
+	// Don't compete with the user for the disk, wait until idle.
+	const auto idle = crl::now() - Core::App().lastNonIdleTime();
+	if (idle < kCacheQuotaIdleTimeout) {
+		_cacheQuotaTimer.callOnce(kCacheQuotaIdleTimeout - idle);
+		return;
+	} else if (mediaPlaying()) {
+		_cacheQuotaTimer.callOnce(kCacheQuotaIdleTimeout);
+		return;
+	}
+
+	// One tag at a time, new stats will bring the next one if needed.
+	const auto [tag, overflow] = _cacheOverQuota.front();
+	_cacheOverQuota.clear();
+
+	// The cache database can't list its entries, so only documents
+	// that were put to or read from the cache in this session are known.
+	// Older entries and photo videos are left for the common size limit.
+	const auto i = _cachedDocuments.find(tag);
+	if (i == end(_cachedDocuments)) {
+		return;
+	}
+	auto &list = i->second;
+	auto removed = int64();
+	auto count = 0;
+	for (auto j = begin(list); j != end(list) && removed < overflow;) {
+		const auto document = j->document;
+		if (document->activeMediaView()) {
+			++j;
+			continue;
+		}
+		_cache->remove(document->cacheKey());
+		removed += j->size;
+		++count;
+		j = list.erase(j);
+	}
+	LOG(("Cache Info: tag %1 is over quota by %2, removed %3 files (%4)."
+		).arg(tag
+		).arg(overflow
+		).arg(count
+		).arg(removed));
+}
+
 void Session::checkLocalUsersWentOffline() {
 	_watchForOfflineTimer.cancel();
 
@@ -1514,6 +1606,23 @@ void Session::documentLoadDone(not_null<DocumentData*> document) {
 	_documentLoadProgress.fire_copy(document);
 }
 
+void Session::documentCached(
+		not_null<DocumentData*> document,
+		int64 size) {
+	const auto tag = document->cacheTag();
+	if (tag != kVideoMessageCacheTag && tag != kAnimationCacheTag) {
+		return;
+	}
+
+	// Keep the list ordered by the last access, oldest first.
+	auto &list = _cachedDocuments[tag];
+	const auto i = ranges::find(list, document, &CachedDocument::document);
+	if (i != end(list)) {
+		list.erase(i);
+	}
+	list.push_back({ .document = document, .size = size });
+}
+
 void Session::documentLoadFail(
 		not_null<DocumentData*> document,
 		bool started) {
@@ -1628,6 +1737,7 @@ void Session::notifyItemIdChange(IdChange event) {
 	_itemIdChanges.fire_copy(event);
 
 	if (item) {
+		_messagesIndex->update(item);
 		const auto refreshViewDataId = [](not_null<ViewElement*> view) {
 			view->refreshDataId();
 		};
@@ -2264,6 +2374,7 @@ void Session::registerMessage(not_null<HistoryItem*> item) {
 		i->second->destroy();
 	}
 	list->emplace(itemId, item);
+	_messagesIndex->add(item);
 
 	if (!peerIsChannel(peerId) && IsServerMsgId(itemId)) {
 		_nonChannelMessages.emplace(itemId, item);
@@ -2392,6 +2503,7 @@ void Session::unregisterMessage(not_null<HistoryItem*> item) {
 		Data::MessageUpdate::Flag::Destroyed);
 	groups().unregisterMessage(item);
 	removeDependencyMessage(item);
+	_messagesIndex->remove(item);
 	messagesListForInsert(peerId)->erase(itemId);
 
 	if (!peerIsChannel(peerId) && IsServerMsgId(itemId)) {
@@ -4141,6 +4253,28 @@ not_null<Dialogs::IndexedList*> Session::contactsNoChatsList() {
 	return &_contactsNoChatsList;
 }
 
+std::vector<not_null<PeerData*>> Session::peersForLocalCache() {
+	auto result = std::vector<not_null<PeerData*>>();
+	const auto add = [&](not_null<Dialogs::IndexedList*> list) {
+		for (const auto &row : list->all()) {
+			if (result.size() >= kPeersLocalCacheLimit) {
+				return;
+			} else if (const auto history = row->history()) {
+				const auto peer = history->peer;
+				if (!peer->isSelf() && peer->isLoaded()) {
+					result.push_back(peer);
+				}
+			}
+		}
+	};
+	add(chatsList()->indexed());
+	if (const auto folder = folderLoaded(Folder::kId)) {
+		add(folder->chatsList()->indexed());
+	}
+	add(contactsNoChatsList());
+	return result;
+}
+
 void Session::refreshChatListEntry(Dialogs::Key key) {
 	Expects(key.entry()->folderKnown());
 
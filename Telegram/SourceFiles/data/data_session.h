@@ -64,6 +64,7 @@ class GroupCall;
 class NotifySettings;
 class CustomEmojiManager;
 class Stories;
+class MessagesIndex;
 
 struct RepliesReadTillUpdate {
 	FullMsgId id;
@@ -140,6 +141,9 @@ public:
 	[[nodiscard]] Stories &stories() const {
 		return *_stories;
 	}
+	[[nodiscard]] MessagesIndex &messagesIndex() const {
+		return *_messagesIndex;
+	}
 
 	[[nodiscard]] MsgId nextNonHistoryEntryId() {
 		return ++_nonHistoryEntryId;
@@ -453,6 +457,7 @@ public:
 	void documentLoadProgress(not_null<DocumentData*> document);
 	void documentLoadDone(not_null<DocumentData*> document);
 	void documentLoadFail(not_null<DocumentData*> document, bool started);
+	void documentCached(not_null<DocumentData*> document, int64 size);
 
 	[[nodiscard]] auto documentLoadProgress() const
 	-> rpl::producer<not_null<DocumentData*>> {
@@ -676,6 +681,9 @@ public:
 	[[nodiscard]] not_null<Dialogs::IndexedList*> contactsList();
 	[[nodiscard]] not_null<Dialogs::IndexedList*> contactsNoChatsList();
 
+	// Peers to keep in the local cache for the next start.
+	[[nodiscard]] std::vector<not_null<PeerData*>> peersForLocalCache();
+
 	struct ChatListEntryRefresh {
 		Dialogs::Key key;
 		Dialogs::PositionChange moved;
@@ -732,8 +740,11 @@ private:
 	void setupChannelLeavingViewer();
 	void setupPeerNameViewer();
 	void setupUserIsContactViewer();
+	void setupCacheQuotas();
 
 	void checkSelfDestructItems();
+	void enforceCacheQuotas();
+	[[nodiscard]] bool mediaPlaying() const;
 	void checkLocalUsersWentOffline();
 
 	void scheduleNextTTLs();
@@ -1001,6 +1012,14 @@ private:
 	base::flat_map<not_null<UserData*>, TimeId> _watchingForOffline;
 	base::Timer _watchForOfflineTimer;
 
+	struct CachedDocument {
+		not_null<DocumentData*> document;
+		int64 size = 0;
+	};
+	base::flat_map<uint8, std::vector<CachedDocument>> _cachedDocuments;
+	base::flat_map<uint8, int64> _cacheOverQuota;
+	base::Timer _cacheQuotaTimer;
+
 	rpl::event_stream<WebViewResultSent> _webViewResultSent;
 
 	Groups _groups;
@@ -1019,6 +1038,7 @@ private:
 	const std::unique_ptr<NotifySettings> _notifySettings;
 	const std::unique_ptr<CustomEmojiManager> _customEmojiManager;
 	const std::unique_ptr<Stories> _stories;
+	const std::unique_ptr<MessagesIndex> _messagesIndex;
 
 	MsgId _nonHistoryEntryId = ServerMaxMsgId.bare + ScheduledMsgIdsRange;
 
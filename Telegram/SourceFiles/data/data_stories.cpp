@@ -37,6 +37,10 @@ constexpr auto kArchivePerPage = 100;
 constexpr auto kSavedFirstPerPage = 30;
 constexpr auto kSavedPerPage = 100;
 constexpr auto kMaxPreloadSources = 10;
+constexpr auto kMaxPreloadSourcesFast = 20;
+constexpr auto kMaxPreloadSourcesSlow = 3;
+constexpr auto kSlowPreloadSpeed = 64 * 1024; // Bytes per second.
+constexpr auto kFastPreloadSpeed = 1024 * 1024;
 constexpr auto kStillPreloadFromFirst = 3;
 constexpr auto kMaxSegmentsCount = 180;
 constexpr auto kPollingIntervalChat = 5 * TimeId(60);
@@ -1705,7 +1709,12 @@ bool Stories::rebuildPreloadSources(StorySourcesList list) {
 	}
 	auto now = std::vector<FullStoryId>();
 	auto processed = 0;
+	const auto limit = preloadSourcesLimit();
+	const auto onlyUnread = preloadConstrained();
 	for (const auto &source : _sources[index]) {
+		if (onlyUnread && !source.unreadCount) {
+			continue;
+		}
 		const auto i = _all.find(source.id);
 		if (i != end(_all)) {
 			if (const auto id = i->second.toOpen().id) {
@@ -1715,7 +1724,7 @@ bool Stories::rebuildPreloadSources(StorySourcesList list) {
 				}
 			}
 		}
-		if (++processed >= kMaxPreloadSources) {
+		if (++processed >= limit) {
 			break;
 		}
 	}
@@ -1726,6 +1735,37 @@ bool Stories::rebuildPreloadSources(StorySourcesList list) {
 	return false;
 }
 
+int Stories::preloadSourcesLimit() const {
+	return !_preloadSpeed
+		? kMaxPreloadSources
+		: (_preloadSpeed < kSlowPreloadSpeed)
+		? kMaxPreloadSourcesSlow
+		: (_preloadSpeed >= kFastPreloadSpeed)
+		? kMaxPreloadSourcesFast
+		: kMaxPreloadSources;
+}
+
+bool Stories::preloadConstrained() const {
+	return _preloadSpeed && (_preloadSpeed < kSlowPreloadSpeed);
+}
+
+void Stories::registerPreloadSpeed(int64 bytes, crl::time duration) {
+	if (bytes <= 0) {
+		return;
+	}
+	const auto speed = bytes * 1000 / std::max(duration, crl::time(1));
+	const auto wasLimit = preloadSourcesLimit();
+	const auto wasConstrained = preloadConstrained();
+	_preloadSpeed = _preloadSpeed
+		? ((_preloadSpeed * 3 + speed) / 4)
+		: speed;
+	if (wasLimit != preloadSourcesLimit()
+		|| wasConstrained != preloadConstrained()) {
+		rebuildPreloadSources(StorySourcesList::NotHidden);
+		rebuildPreloadSources(StorySourcesList::Hidden);
+	}
+}
+
 void Stories::continuePreloading() {
 	const auto now = _preloading ? _preloading->id() : FullStoryId();
 	if (now) {
@@ -200,6 +200,7 @@ public:
 	void incrementPreloadingHiddenSources();
 	void decrementPreloadingHiddenSources();
 	void setPreloadingInViewer(std::vector<FullStoryId> ids);
+	void registerPreloadSpeed(int64 bytes, crl::time duration);
 
 	struct PeerSourceState {
 		StoryId maxId = 0;
@@ -276,6 +277,8 @@ private:
 
 	void preloadSourcesChanged(StorySourcesList list);
 	bool rebuildPreloadSources(StorySourcesList list);
+	[[nodiscard]] int preloadSourcesLimit() const;
+	[[nodiscard]] bool preloadConstrained() const;
 	void continuePreloading();
 	[[nodiscard]] bool shouldContinuePreload(FullStoryId id) const;
 	[[nodiscard]] FullStoryId nextPreloadId() const;
@@ -362,6 +365,7 @@ private:
 	std::unique_ptr<StoryPreload> _preloading;
 	int _preloadingHiddenSourcesCounter = 0;
 	int _preloadingMainSourcesCounter = 0;
+	int64 _preloadSpeed = 0;
 
 	base::flat_map<PeerId, StoryId> _readTill;
 	base::flat_set<FullStoryId> _pendingReadTillItems;
@@ -572,8 +572,12 @@ void StoryPreload::load() {
 		callDone();
 		return;
 	}
+	const auto started = crl::now();
 	_task = std::make_unique<LoadTask>(id(), video, [=](QByteArray data) {
 		if (!data.isEmpty()) {
+			_story->owner().stories().registerPreloadSpeed(
+				prefix,
+				crl::now() - started);
 			_story->owner().cacheBigFile().putIfEmpty(
 				key,
 				Storage::Cache::Database::TaggedValue(std::move(data), 0));
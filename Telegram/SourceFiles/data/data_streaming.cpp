@@ -160,6 +160,14 @@ void Streaming::keepAlive(not_null<PhotoData*> photo) {
 	keepAlive(_photoDocuments, photo);
 }
 
+bool Streaming::hasActiveReaders() const {
+	const auto alive = [](const auto &pair) {
+		return !pair.second.expired();
+	};
+	return ranges::any_of(_fileReaders, alive)
+		|| ranges::any_of(_photoReaders, alive);
+}
+
 void Streaming::clearKeptAlive() {
 	const auto now = crl::now();
 	auto min = std::numeric_limits<crl::time>::max();
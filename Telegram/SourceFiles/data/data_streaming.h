@@ -53,6 +53,8 @@ public:
 	void keepAlive(not_null<DocumentData*> document);
 	void keepAlive(not_null<PhotoData*> photo);
 
+	[[nodiscard]] bool hasActiveReaders() const;
+
 private:
 	void clearKeptAlive();
 
@@ -34,6 +34,7 @@ namespace Data {
 namespace {
 
 constexpr auto kMaxPerRequest = 100;
+constexpr auto kDecodedFramesInterval = crl::time(1000);
 #if 0 // inject-to-on_main
 constexpr auto kUnsubscribeUpdatesDelay = 3 * crl::time(1000);
 #endif
@@ -56,6 +57,45 @@ private:
 
 };
 
+class CountingFrameGenerator final : public Ui::FrameGenerator {
+public:
+	CountingFrameGenerator(
+		std::unique_ptr<Ui::FrameGenerator> generator,
+		std::shared_ptr<std::atomic<int>> counter)
+	: _generator(std::move(generator))
+	, _counter(std::move(counter)) {
+	}
+
+	int count() override {
+		return _generator->count();
+	}
+	double rate() override {
+		return _generator->rate();
+	}
+	Frame renderNext(
+			QImage storage,
+			QSize size,
+			Qt::AspectRatioMode mode) override {
+		++*_counter;
+		return _generator->renderNext(std::move(storage), size, mode);
+	}
+	Frame renderCurrent(
+			QImage storage,
+			QSize size,
+			Qt::AspectRatioMode mode) override {
+		++*_counter;
+		return _generator->renderCurrent(std::move(storage), size, mode);
+	}
+	void jumpToStart() override {
+		_generator->jumpToStart();
+	}
+
+private:
+	const std::unique_ptr<Ui::FrameGenerator> _generator;
+	const std::shared_ptr<std::atomic<int>> _counter;
+
+};
+
 [[nodiscard]] ChatHelpers::StickerLottieSize LottieSizeFromTag(SizeTag tag) {
 	// NB! onlyCustomEmoji dimensions caching uses last ::EmojiInteraction-s.
 	using LottieSize = ChatHelpers::StickerLottieSize;
@@ -347,15 +387,22 @@ void CustomEmojiLoader::check() {
 		document->owner().cacheBigFile().put(key, std::move(value));
 	};
 	const auto type = document->sticker()->type;
+	const auto counter = document->owner().customEmojiManager(
+	).decodedFramesCounter();
 	auto generator = [=, bytes = Lottie::ReadContent(data, filepath)]()
 	-> std::unique_ptr<Ui::FrameGenerator> {
+		const auto wrap = [&](std::unique_ptr<Ui::FrameGenerator> result) {
+			return std::make_unique<CountingFrameGenerator>(
+				std::move(result),
+				counter);
+		};
 		switch (type) {
 		case StickerType::Tgs:
-			return std::make_unique<Lottie::FrameGenerator>(bytes);
+			return wrap(std::make_unique<Lottie::FrameGenerator>(bytes));
 		case StickerType::Webm:
-			return std::make_unique<FFmpeg::FrameGenerator>(bytes);
+			return wrap(std::make_unique<FFmpeg::FrameGenerator>(bytes));
 		case StickerType::Webp:
-			return std::make_unique<Ui::ImageFrameGenerator>(bytes);
+			return wrap(std::make_unique<Ui::ImageFrameGenerator>(bytes));
 		}
 		Unexpected("Type in custom emoji sticker frame generator.");
 	};
@@ -414,7 +461,9 @@ Ui::CustomEmoji::Preview CustomEmojiLoader::preview() {
 
 CustomEmojiManager::CustomEmojiManager(not_null<Session*> owner)
 : _owner(owner)
-, _repaintTimer([=] { invokeRepaints(); }) {
+, _repaintTimer([=] { invokeRepaints(); })
+, _decodedFrames(std::make_shared<std::atomic<int>>(0))
+, _decodedFramesTimer([=] { collectDecodedFrames(); }) {
 	const auto appConfig = &owner->session().account().appConfig();
 	appConfig->value(
 	) | rpl::take_while([=] {
@@ -879,6 +928,31 @@ uint64 CustomEmojiManager::coloredSetId() const {
 	return _coloredSetId;
 }
 
+int CustomEmojiManager::decodedFramesPerSecond() const {
+	return _decodedFramesPerSecond;
+}
+
+auto CustomEmojiManager::decodedFramesCounter()
+-> std::shared_ptr<std::atomic<int>> {
+	if (!_decodedFramesTimer.isActive()) {
+		_decodedFramesTimer.callEach(kDecodedFramesInterval);
+	}
+	return _decodedFrames;
+}
+
+void CustomEmojiManager::collectDecodedFrames() {
+	const auto decoded = _decodedFrames->exchange(0);
+	_decodedFramesPerSecond = decoded * crl::time(1000)
+		/ kDecodedFramesInterval;
+	if (!decoded) {
+		// Renderers finished caching, restart with the next one.
+		_decodedFramesTimer.cancel();
+	} else {
+		DEBUG_LOG(("Custom Emoji: %1 frames decoded per second."
+			).arg(_decodedFramesPerSecond));
+	}
+}
+
 int FrameSizeFromTag(SizeTag tag) {
 	const auto emoji = EmojiSizeFromTag(tag);
 	const auto factor = style::DevicePixelRatio();
@@ -85,6 +85,13 @@ public:
 
 	[[nodiscard]] uint64 coloredSetId() const;
 
+	// Frames decoded by all custom emoji renderers during the last second.
+	// Each (document, size) pair is decoded once into the shared sprite
+	// cache of its Ui::CustomEmoji::Instance and painted by every object.
+	[[nodiscard]] int decodedFramesPerSecond() const;
+	[[nodiscard]] auto decodedFramesCounter()
+		-> std::shared_ptr<std::atomic<int>>;
+
 private:
 	static constexpr auto kSizeCount = int(SizeTag::kCount);
 
@@ -163,6 +170,12 @@ private:
 	bool _repaintTimerScheduled = false;
 	bool _requestSetsScheduled = false;
 
+	void collectDecodedFrames();
+
+	const std::shared_ptr<std::atomic<int>> _decodedFrames;
+	base::Timer _decodedFramesTimer;
+	int _decodedFramesPerSecond = 0;
+
 #if 0 // inject-to-on_main
 	crl::time _repaintsLastAdded = 0;
 	rpl::lifetime _repaintsLifetime;
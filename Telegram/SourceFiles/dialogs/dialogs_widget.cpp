@@ -56,6 +56,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_account.h"
 #include "storage/storage_domain.h"
 #include "data/data_session.h"
+#include "data/data_messages_index.h"
 #include "data/data_channel.h"
 #include "data/data_chat.h"
 #include "data/data_user.h"
@@ -1662,6 +1663,7 @@ bool Widget::searchMessages(bool searchCache) {
 	auto q = currentSearchQuery().trimmed();
 	if (q.isEmpty() && !_searchFromAuthor) {
 		cancelSearchRequest();
+		_localSearchResults.clear();
 		_api.request(base::take(_peerSearchRequest)).cancel();
 		_api.request(base::take(_topicSearchRequest)).cancel();
 		return true;
@@ -1680,6 +1682,7 @@ bool Widget::searchMessages(bool searchCache) {
 			_searchNextRate = 0;
 			_searchFull = _searchFullMigrated = false;
 			cancelSearchRequest();
+			_localSearchResults.clear();
 			searchReceived(
 				((_searchInChat || _openedForum)
 					? SearchRequestType::PeerFromStart
@@ -1694,6 +1697,7 @@ bool Widget::searchMessages(bool searchCache) {
 		_searchNextRate = 0;
 		_searchFull = _searchFullMigrated = false;
 		cancelSearchRequest();
+		searchLocal();
 		if (const auto peer = searchInPeer()) {
 			const auto topic = searchInTopic();
 			auto &histories = session().data().histories();
@@ -2181,6 +2185,11 @@ void Widget::searchReceived(
 		}
 		return std::vector<not_null<HistoryItem*>>();
 	});
+	if (type == SearchRequestType::FromStart
+		|| type == SearchRequestType::PeerFromStart) {
+		// The server count may already include the local results.
+		mergeLocalSearchResults(messages);
+	}
 	_inner->searchReceived(messages, inject, type, fullCount);
 
 	_searchRequest = 0;
@@ -2188,6 +2197,65 @@ void Widget::searchReceived(
 	update();
 }
 
+void Widget::searchLocal() {
+	const auto peer = searchInPeer();
+	const auto topic = searchInTopic();
+	const auto type = peer
+		? SearchRequestType::PeerFromStart
+		: SearchRequestType::FromStart;
+	auto items = session().data().messagesIndex().search({
+		.text = _searchQuery,
+		.inHistory = peer ? session().data().history(peer).get() : nullptr,
+		.topicRootId = topic ? topic->rootId() : MsgId(),
+		.from = _searchQueryFrom,
+		.skipArchive = session().settings().skipArchiveInSearch(),
+		.limit = kSearchPerPage,
+	});
+	_localSearchResults = ranges::views::all(
+		items
+	) | ranges::views::transform([](not_null<HistoryItem*> item) {
+		return item->fullId();
+	}) | ranges::to_vector;
+	if (items.empty()) {
+		return;
+	}
+	const auto count = int(items.size());
+	_inner->searchReceived(std::move(items), nullptr, type, count);
+	listScrollUpdated();
+	update();
+}
+
+void Widget::mergeLocalSearchResults(
+		std::vector<not_null<HistoryItem*>> &messages) {
+	const auto local = base::take(_localSearchResults);
+	if (local.empty()) {
+		return;
+	}
+
+	// Server results are sorted by date, keep only the local ones that
+	// fit in the loaded page, the rest will come with the next pages.
+	const auto full = _searchFull;
+	const auto oldest = messages.empty() ? TimeId() : messages.back()->date();
+	auto added = 0;
+	for (const auto &id : local) {
+		const auto item = session().data().message(id);
+		if (!item
+			|| (!full && item->date() < oldest)
+			|| ranges::contains(messages, not_null<HistoryItem*>(item))) {
+			continue;
+		}
+		messages.push_back(item);
+		++added;
+	}
+	if (added) {
+		ranges::stable_sort(messages, [](
+				not_null<HistoryItem*> a,
+				not_null<HistoryItem*> b) {
+			return a->date() > b->date();
+		});
+	}
+}
+
 void Widget::peerSearchReceived(
 		const MTPcontacts_Found &result,
 		mtpRequestId requestId) {
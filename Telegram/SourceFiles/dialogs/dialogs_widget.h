@@ -154,6 +154,9 @@ private:
 		SearchRequestType type,
 		const MTPmessages_Messages &result,
 		mtpRequestId requestId);
+	void searchLocal();
+	void mergeLocalSearchResults(
+		std::vector<not_null<HistoryItem*>> &messages);
 	void peerSearchReceived(
 		const MTPcontacts_Found &result,
 		mtpRequestId requestId);
@@ -320,6 +323,8 @@ private:
 	MsgId _lastSearchId = 0;
 	MsgId _lastSearchMigratedId = 0;
 
+	std::vector<FullMsgId> _localSearchResults;
+
 	base::flat_map<QString, MTPmessages_Messages> _searchCache;
 	Api::SingleMessageSearch _singleMessageSearch;
 	base::flat_map<mtpRequestId, QString> _searchQueries;
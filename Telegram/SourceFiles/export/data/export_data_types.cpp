@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <QtCore/QDateTime>
 #include <QtCore/QTimeZone>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QMutex>
 #include <QtGui/QImageReader>
 #include <range/v3/algorithm/max_element.hpp>
 #include <range/v3/view/all.hpp>
@@ -52,6 +53,11 @@ QString PrepareStoryFileName(
 		+ extension;
 }
 
+QMutex &ThumbsMutex() {
+	static QMutex result;
+	return result;
+}
+
 } // namespace
 
 int PeerColorIndex(BareId bareId) {
@@ -726,6 +732,10 @@ std::pair<QString, QSize> WriteImageThumb(
 	const auto thumb = (firstDot >= 0)
 		? largePath.mid(0, firstDot) + postfix + largePath.mid(firstDot)
 		: largePath + postfix;
+
+	// Thumbs may be written from several threads, while the file name
+	// is chosen by checking which files already exist.
+	QMutexLocker lock(&ThumbsMutex());
 	const auto result = Output::File::PrepareRelativePath(basePath, thumb);
 	if (!image.save(
 			basePath + result,
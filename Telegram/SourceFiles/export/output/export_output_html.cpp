@@ -21,6 +21,7 @@ namespace Output {
 namespace {
 
 constexpr auto kMessagesInFile = 1000;
+constexpr auto kMessagesInRenderChunk = 16;
 constexpr auto kPersonalUserpicSize = 90;
 constexpr auto kEntryUserpicSize = 48;
 constexpr auto kServiceMessagePhotoSize = 60;
@@ -109,9 +110,23 @@ QByteArray SerializeString(const QByteArray &value) {
 	const auto begin = value.data();
 	const auto end = begin + size;
 
+	// Most strings don't need escaping, return them without copying.
+	const auto first = std::find_if(begin, end, [](char ch) {
+		return (ch >= 0 && ch < 32)
+			|| (ch == '"')
+			|| (ch == '&')
+			|| (ch == '\'')
+			|| (ch == '<')
+			|| (ch == '>')
+			|| (ch == char(0xE2));
+	});
+	if (first == end) {
+		return value;
+	}
 	auto result = QByteArray();
-	result.reserve(size * 6);
-	for (auto p = begin; p != end; ++p) {
+	result.reserve((first - begin) + (end - first) * 6);
+	result.append(begin, first - begin);
+	for (auto p = first; p != end; ++p) {
 		const auto ch = *p;
 		if (ch == '\n') {
 			result.append("<br>", 4);
@@ -560,6 +575,11 @@ public:
 		const PeersMap &peers,
 		const QString &internalLinksDomain,
 		Fn<QByteArray(int messageId, QByteArray text)> wrapMessageLink);
+	[[nodiscard]] MessageInfo prepareMessageInfo(
+		const Data::Message &message) const;
+
+	// Not bound to a file, renders blocks nested like in this one.
+	[[nodiscard]] std::unique_ptr<Wrap> renderer() const;
 
 	[[nodiscard]] Result writeBlock(const QByteArray &block);
 
@@ -571,6 +591,8 @@ public:
 	~Wrap();
 
 private:
+	explicit Wrap(not_null<const Wrap*> parent);
+
 	[[nodiscard]] QByteArray composeStart();
 	[[nodiscard]] QByteArray pushGenericListEntry(
 		const QString &link,
@@ -580,6 +602,13 @@ private:
 		std::initializer_list<QByteArray> details,
 		const QByteArray &info);
 
+	[[nodiscard]] MessageInfo prepareMessageInfoBase(
+		const Data::Message &message) const;
+	[[nodiscard]] QByteArray composeServiceText(
+		const Data::Message &message,
+		const Data::DialogInfo &dialog,
+		const PeersMap &peers,
+		Fn<QByteArray(int messageId, QByteArray text)> wrapMessageLink) const;
 	[[nodiscard]] bool messageNeedsWrap(
 		const Data::Message &message,
 		const MessageInfo *previous) const;
@@ -620,6 +649,12 @@ private:
 
 };
 
+struct HtmlWriter::PendingMessage {
+	not_null<const Data::Message*> message;
+	MessageInfo info;
+	int dateMessageId = 0;
+};
+
 struct HtmlWriter::SavedSection {
 	int priority = 0;
 	QByteArray label;
@@ -685,6 +720,17 @@ HtmlWriter::Wrap::Wrap(
 	_composedStart = composeStart();
 }
 
+HtmlWriter::Wrap::Wrap(not_null<const Wrap*> parent)
+: _file(QString(), nullptr)
+, _closed(true)
+, _base(parent->_base)
+, _context(parent->_context) {
+}
+
+std::unique_ptr<HtmlWriter::Wrap> HtmlWriter::Wrap::renderer() const {
+	return std::unique_ptr<Wrap>(new Wrap(this));
+}
+
 bool HtmlWriter::Wrap::empty() const {
 	return _file.empty();
 }
@@ -1005,17 +1051,8 @@ QByteArray HtmlWriter::Wrap::pushServiceMessage(
 	return result;
 }
 
-auto HtmlWriter::Wrap::pushMessage(
-	const Data::Message &message,
-	const MessageInfo *previous,
-	const Data::DialogInfo &dialog,
-	const QString &basePath,
-	const PeersMap &peers,
-	const QString &internalLinksDomain,
-	Fn<QByteArray(int messageId, QByteArray text)> wrapMessageLink
-) -> std::pair<MessageInfo, QByteArray> {
-	using namespace Data;
-
+auto HtmlWriter::Wrap::prepareMessageInfoBase(
+		const Data::Message &message) const -> MessageInfo {
 	auto info = MessageInfo();
 	info.id = message.id;
 	info.fromId = message.fromId;
@@ -1026,14 +1063,30 @@ auto HtmlWriter::Wrap::pushMessage(
 	info.forwardedDate = message.forwardedDate;
 	info.forwarded = message.forwarded;
 	info.showForwardedAsOriginal = message.showForwardedAsOriginal;
-	if (v::is<UnsupportedMedia>(message.media.content)) {
-		return { info, pushServiceMessage(
-			message.id,
-			dialog,
-			basePath,
-			"This message is not supported by this version "
-			"of Telegram Desktop. Please update the application.") };
-	}
+	return info;
+}
+
+auto HtmlWriter::Wrap::prepareMessageInfo(
+		const Data::Message &message) const -> MessageInfo {
+	auto info = prepareMessageInfoBase(message);
+
+	// Same as a non-empty composeServiceText(), which skips phone calls.
+	const auto &action = message.action.content;
+	const auto service = v::is<Data::UnsupportedMedia>(message.media.content)
+		|| (!v::is<v::null_t>(action)
+			&& !v::is<Data::ActionPhoneCall>(action));
+	info.type = service
+		? MessageInfo::Type::Service
+		: MessageInfo::Type::Default;
+	return info;
+}
+
+QByteArray HtmlWriter::Wrap::composeServiceText(
+		const Data::Message &message,
+		const Data::DialogInfo &dialog,
+		const PeersMap &peers,
+		Fn<QByteArray(int messageId, QByteArray text)> wrapMessageLink) const {
+	using namespace Data;
 
 	const auto wrapReplyToLink = [&](const QByteArray &text) {
 		return wrapMessageLink(message.replyToMsgId, text);
@@ -1043,7 +1096,7 @@ auto HtmlWriter::Wrap::pushMessage(
 	const auto isChannel = (dialog.type == DialogType::PrivateChannel)
 		|| (dialog.type == DialogType::PublicChannel);
 	const auto serviceFrom = peers.wrapPeerName(message.fromId);
-	const auto serviceText = v::match(message.action.content, [&](
+	return v::match(message.action.content, [&](
 			const ActionChatCreate &data) {
 		return serviceFrom
 			+ " created group &laquo;"
@@ -1275,6 +1328,38 @@ auto HtmlWriter::Wrap::pushMessage(
 			+ wrapReplyToLink("the same background")
 			+ " for this chat";
 	}, [](v::null_t) { return QByteArray(); });
+}
+
+auto HtmlWriter::Wrap::pushMessage(
+	const Data::Message &message,
+	const MessageInfo *previous,
+	const Data::DialogInfo &dialog,
+	const QString &basePath,
+	const PeersMap &peers,
+	const QString &internalLinksDomain,
+	Fn<QByteArray(int messageId, QByteArray text)> wrapMessageLink
+) -> std::pair<MessageInfo, QByteArray> {
+	using namespace Data;
+
+	auto info = prepareMessageInfoBase(message);
+	if (v::is<UnsupportedMedia>(message.media.content)) {
+		return { info, pushServiceMessage(
+			message.id,
+			dialog,
+			basePath,
+			"This message is not supported by this version "
+			"of Telegram Desktop. Please update the application.") };
+	}
+
+	const auto wrapReplyToLink = [&](const QByteArray &text) {
+		return wrapMessageLink(message.replyToMsgId, text);
+	};
+
+	const auto serviceText = composeServiceText(
+		message,
+		dialog,
+		peers,
+		wrapMessageLink);
 
 	if (!serviceText.isEmpty()) {
 		const auto &content = message.action.content;
@@ -2668,32 +2753,40 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	Expects(_chat != nullptr);
 	Expects(!data.list.empty());
 
-	const auto messageLinkWrapper = [&](int messageId, QByteArray text) {
-		return wrapMessageLink(messageId, text);
-	};
 	auto oldIndex = (_messagesCount > 0)
 		? ((_messagesCount - 1) / kMessagesInFile)
 		: 0;
-	auto previous = _lastMessageInfo.get();
-	auto saved = std::optional<MessageInfo>();
-	auto block = QByteArray();
+	auto first = _lastMessageInfo
+		? std::make_optional(*_lastMessageInfo)
+		: std::nullopt;
+	auto pending = std::vector<PendingMessage>();
+	pending.reserve(data.list.size());
+	const auto previous = [&]() -> const MessageInfo* {
+		return !pending.empty()
+			? &pending.back().info
+			: first
+			? &*first
+			: nullptr;
+	};
 	for (const auto &message : data.list) {
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
 		const auto newIndex = (_messagesCount / kMessagesInFile);
 		if (oldIndex != newIndex) {
-			if (const auto result = _chat->writeBlock(block); !result) {
+			const auto last = previous();
+			Assert(last != nullptr);
+			const auto lastId = last->id;
+			if (const auto result = writePendingMessages(
+					pending,
+					first ? &*first : nullptr,
+					data.peers); !result) {
 				return result;
 			} else if (const auto next = switchToNextChatFile(newIndex)) {
-				Assert(saved.has_value() || _lastMessageInfo != nullptr);
-				_lastMessageIdsPerFile.push_back(saved
-					? saved->id
-					: _lastMessageInfo->id);
-				block = QByteArray();
+				_lastMessageIdsPerFile.push_back(lastId);
 				_lastMessageInfo = nullptr;
-				previous = nullptr;
-				saved = std::nullopt;
+				pending.clear();
+				first = std::nullopt;
 				oldIndex = newIndex;
 			} else {
 				return next;
@@ -2705,32 +2798,94 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 			}
 			_chatFileEmpty = false;
 		}
+		const auto last = previous();
 		const auto date = message.date;
-		if (DisplayDate(date, previous ? previous->date : 0)) {
-			block.append(_chat->pushServiceMessage(
-				--_dateMessageId,
+		pending.push_back({
+			.message = &message,
+			.info = _chat->prepareMessageInfo(message),
+			.dateMessageId = (DisplayDate(date, last ? last->date : 0)
+				? --_dateMessageId
+				: 0),
+		});
+		++_messagesCount;
+	}
+	if (!pending.empty()) {
+		_lastMessageInfo = std::make_unique<MessageInfo>(
+			pending.back().info);
+	}
+	return writePendingMessages(
+		pending,
+		first ? &*first : nullptr,
+		data.peers);
+}
+
+Result HtmlWriter::writePendingMessages(
+		const std::vector<PendingMessage> &list,
+		const MessageInfo *previous,
+		const PeersMap &peers) {
+	Expects(_chat != nullptr);
+
+	if (list.empty()) {
+		return Result::Success();
+	}
+	const auto messageLinkWrapper = [&](int messageId, QByteArray text) {
+		return wrapMessageLink(messageId, text);
+	};
+	const auto render = [&](not_null<Wrap*> wrap, int from, int till) {
+		auto block = QByteArray();
+		for (auto i = from; i != till; ++i) {
+			const auto &entry = list[i];
+			if (entry.dateMessageId) {
+				block.append(wrap->pushServiceMessage(
+					entry.dateMessageId,
+					_dialog,
+					_settings.path,
+					FormatDateText(entry.message->date)));
+			}
+			block.append(wrap->pushMessage(
+				*entry.message,
+				i ? &list[i - 1].info : previous,
 				_dialog,
 				_settings.path,
-				FormatDateText(date)));
+				peers,
+				_environment.internalLinksDomain,
+				messageLinkWrapper).second);
 		}
-		const auto [info, content] = _chat->pushMessage(
-			message,
-			previous,
-			_dialog,
-			_settings.path,
-			data.peers,
-			_environment.internalLinksDomain,
-			messageLinkWrapper);
-		block.append(content);
-
-		++_messagesCount;
-		saved = info;
-		previous = &*saved;
+		return block;
+	};
+	const auto count = int(list.size());
+	const auto chunks = (count + kMessagesInRenderChunk - 1)
+		/ kMessagesInRenderChunk;
+	if (chunks < 2) {
+		return _chat->writeBlock(render(_chat.get(), 0, count));
+	}
+
+	// Each chunk is rendered on its own thread with its own tags nesting,
+	// the blocks are written to the file in the original order.
+	struct Chunk {
+		std::unique_ptr<Wrap> wrap;
+		QByteArray block;
+		crl::semaphore ready;
+	};
+	auto rendered = std::vector<Chunk>(chunks);
+	for (auto i = 0; i != chunks; ++i) {
+		const auto chunk = &rendered[i];
+		const auto from = i * kMessagesInRenderChunk;
+		const auto till = std::min(from + kMessagesInRenderChunk, count);
+		chunk->wrap = _chat->renderer();
+		crl::async([=, &render] {
+			chunk->block = render(chunk->wrap.get(), from, till);
+			chunk->ready.release();
+		});
 	}
-	if (saved) {
-		_lastMessageInfo = std::make_unique<MessageInfo>(*saved);
+	auto result = Result::Success();
+	for (auto &chunk : rendered) {
+		chunk.ready.acquire();
+		if (result) {
+			result = _chat->writeBlock(chunk.block);
+		}
 	}
-	return block.isEmpty() ? Result::Success() : _chat->writeBlock(block);
+	return result;
 }
 
 Result HtmlWriter::writeEmptySinglePeer() {
@@ -88,6 +88,7 @@ private:
 	using MediaData = details::MediaData;
 	class Wrap;
 	struct MessageInfo;
+	struct PendingMessage;
 	enum class DialogsMode {
 		None,
 		Chats,
@@ -112,6 +113,10 @@ private:
 
 	[[nodiscard]] Result validateDialogsMode(bool isLeftChannel);
 	[[nodiscard]] Result writeDialogOpening(int index);
+	[[nodiscard]] Result writePendingMessages(
+		const std::vector<PendingMessage> &list,
+		const MessageInfo *previous,
+		const details::PeersMap &peers);
 	[[nodiscard]] Result switchToNextChatFile(int index);
 	[[nodiscard]] Result writeEmptySinglePeer();
 
@@ -118,6 +118,7 @@ namespace {
 
 constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kUnloadHeavyPartsPages = 2;
+constexpr auto kPreloadMediaItemsLimit = 32;
 constexpr auto kClearUserpicsAfter = 50;
 
 // Helper binary search for an item in a list that is not completely
@@ -3004,6 +3005,53 @@ void HistoryInner::keyPressEvent(QKeyEvent *e) {
 	}
 }
 
+void HistoryInner::preloadMediaAhead(bool scrolledUp, int scrolled) {
+	const auto visibleAreaHeight = _visibleAreaBottom - _visibleAreaTop;
+	if (visibleAreaHeight <= 0) {
+		return;
+	}
+
+	// Look further ahead on fast scroll, but not further than heavy
+	// parts are kept, otherwise they would be unloaded right away.
+	const auto now = crl::now();
+	const auto elapsed = std::max(now - _preloadMediaTime, crl::time(1));
+	const auto speed = int64(scrolled) * 1000 / elapsed;
+	const auto pages = std::clamp(
+		int(speed / visibleAreaHeight),
+		1,
+		kUnloadHeavyPartsPages);
+	_preloadMediaTime = now;
+
+	auto edge = (Element*)nullptr;
+	const auto findEdge = [&](not_null<Element*> view, int, int) {
+		edge = view;
+		return false;
+	};
+	if (scrolledUp) {
+		enumerateItems<EnumItemsDirection::TopToBottom>(findEdge);
+	} else {
+		enumerateItems<EnumItemsDirection::BottomToTop>(findEdge);
+	}
+	const auto next = [&](not_null<Element*> view) {
+		return scrolledUp ? view->previousInBlocks() : view->nextInBlocks();
+	};
+	const auto till = scrolledUp
+		? (_visibleAreaTop - pages * visibleAreaHeight)
+		: (_visibleAreaBottom + pages * visibleAreaHeight);
+	auto left = kPreloadMediaItemsLimit;
+	for (auto view = edge ? next(edge) : nullptr
+		; view && left--
+		; view = next(view)) {
+		const auto top = itemTop(view);
+		if (top < 0
+			|| (scrolledUp ? (top + view->height() <= till) : (top >= till))) {
+			break;
+		} else if (const auto media = view->media()) {
+			media->preloadForDisplay();
+		}
+	}
+}
+
 void HistoryInner::checkActivation() {
 	if (!_widget->markingMessagesRead()) {
 		return;
@@ -3125,6 +3173,7 @@ bool HistoryInner::wasSelectedText() const {
 
 void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	auto scrolledUp = (top < _visibleAreaTop);
+	const auto scrolled = std::abs(top - _visibleAreaTop);
 	_visibleAreaTop = top;
 	_visibleAreaBottom = bottom;
 	const auto visibleAreaHeight = bottom - top;
@@ -3178,6 +3227,7 @@ void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 			from,
 			till);
 	}
+	preloadMediaAhead(scrolledUp, scrolled);
 	checkActivation();
 
 	_emojiInteractions->visibleAreaUpdated(
@@ -295,6 +295,7 @@ private:
 	template <typename Method>
 	void enumerateDates(Method method);
 
+	void preloadMediaAhead(bool scrolledUp, int scrolled);
 	void scrollDateCheck();
 	void scrollDateHideByTimer();
 	bool canHaveFromUserpics() const;
@@ -443,6 +444,7 @@ private:
 	// Save visible area coords for painting / pressing userpics.
 	int _visibleAreaTop = 0;
 	int _visibleAreaBottom = 0;
+	crl::time _preloadMediaTime = 0;
 
 	// With migrated history we perhaps do not need to display
 	// the first _history message date (just skip it by height).
@@ -53,6 +53,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_scheduled_messages.h"
 #include "data/data_changes.h"
 #include "data/data_session.h"
+#include "data/data_messages_index.h"
 #include "data/data_message_reactions.h"
 #include "data/data_messages.h"
 #include "data/data_media_types.h"
@@ -2852,6 +2853,9 @@ void HistoryItem::setTextValue(TextWithEntities text) {
 	if (had) {
 		history()->owner().requestItemTextRefresh(this);
 	}
+	if (isRegular() && history()->owner().message(fullId()) == this) {
+		history()->owner().messagesIndex().update(this);
+	}
 }
 
 bool HistoryItem::showNotification() const {
@@ -82,6 +82,8 @@ constexpr auto kPreloadIfLessThanScreens = 2;
 constexpr auto kPreloadedScreensCountFull
 	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
 constexpr auto kClearUserpicsAfter = 50;
+constexpr auto kPreloadMediaPages = 2;
+constexpr auto kPreloadMediaItemsLimit = 32;
 
 [[nodiscard]] std::unique_ptr<TranslateTracker> MaybeTranslateTracker(
 		History *history) {
@@ -984,6 +986,7 @@ void ListWidget::visibleTopBottomUpdated(
 
 	const auto initializing = !(_visibleTop < _visibleBottom);
 	const auto scrolledUp = (visibleTop < _visibleTop);
+	const auto scrolled = std::abs(visibleTop - _visibleTop);
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 
@@ -996,6 +999,9 @@ void ListWidget::visibleTopBottomUpdated(
 		checkUnreadBarCreation();
 	}
 	updateVisibleTopItem();
+	if (!initializing) {
+		preloadMediaAhead(scrolledUp, scrolled);
+	}
 	if (scrolledUp) {
 		_scrollDateCheck.call();
 	} else {
@@ -1012,6 +1018,41 @@ void ListWidget::applyUpdatedScrollState() {
 	checkMoveToOtherViewer();
 }
 
+void ListWidget::preloadMediaAhead(bool scrolledUp, int scrolled) {
+	const auto visibleHeight = _visibleBottom - _visibleTop;
+	if (_items.empty() || visibleHeight <= 0) {
+		return;
+	}
+	const auto now = crl::now();
+	const auto elapsed = std::max(now - _preloadMediaTime, crl::time(1));
+	const auto speed = int64(scrolled) * 1000 / elapsed;
+	const auto pages = std::clamp(
+		int(speed / visibleHeight),
+		1,
+		kPreloadMediaPages);
+	_preloadMediaTime = now;
+
+	const auto delta = scrolledUp ? -1 : 1;
+	const auto till = scrolledUp
+		? (_visibleTop - pages * visibleHeight)
+		: (_visibleBottom + pages * visibleHeight);
+	const auto from = findItemIndexByY(scrolledUp
+		? _visibleTop
+		: (_visibleBottom - 1));
+	auto left = kPreloadMediaItemsLimit;
+	for (auto i = from + delta
+		; i >= 0 && i < int(_items.size()) && left--
+		; i += delta) {
+		const auto view = _items[i];
+		const auto top = itemTop(view);
+		if (scrolledUp ? (top + view->height() <= till) : (top >= till)) {
+			break;
+		} else if (const auto media = view->media()) {
+			media->preloadForDisplay();
+		}
+	}
+}
+
 void ListWidget::updateVisibleTopItem() {
 	if (_visibleBottom == height()) {
 		_visibleTopItem = nullptr;
@@ -477,6 +477,7 @@ private:
 
 	void checkMoveToOtherViewer();
 	void updateVisibleTopItem();
+	void preloadMediaAhead(bool scrolledUp, int scrolled);
 	void updateItemsGeometry();
 	void updateSize();
 	void refreshAttachmentsFromTill(int from, int till);
@@ -657,6 +658,7 @@ private:
 	int _minHeight = 0;
 	int _visibleTop = 0;
 	int _visibleBottom = 0;
+	crl::time _preloadMediaTime = 0;
 	Element *_visibleTopItem = nullptr;
 	int _visibleTopFromItem = 0;
 	ScrollTopState _scrollTopState;
@@ -21,6 +21,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 #include "spellcheck/platform/platform_language.h"
 
+#include <xxhash.h>
+
 namespace HistoryView {
 namespace {
 
@@ -29,6 +31,12 @@ constexpr auto kEnoughForTranslation = 6;
 constexpr auto kMaxCheckInBunch = 100;
 constexpr auto kRequestLengthLimit = 24 * 1024;
 constexpr auto kRequestCountLimit = 20;
+constexpr auto kMaxRecognizeInBatch = 20;
+constexpr auto kMaxRecognizedCached = 1024;
+
+[[nodiscard]] uint64 TextHash(const QString &text) {
+	return XXH64(text.data(), text.size() * sizeof(ushort), 0);
+}
 
 } // namespace
 
@@ -135,10 +143,13 @@ bool TranslateTracker::add(
 		return true;
 	}
 	const auto &text = item->originalText().text;
+	const auto textHash = TextHash(text);
+	const auto cached = _recognizedCache.find(textHash);
 	_itemsForRecognize.emplace(id, ItemForRecognize{
 		.generation = _generation,
-		.id = (_trackingLanguage.current()
-			? Platform::Language::Recognize(text)
+		.textHash = textHash,
+		.id = ((cached != end(_recognizedCache))
+			? MaybeLanguageId{ cached->second }
 			: MaybeLanguageId{ text }),
 	});
 	++_addedInBunch;
@@ -161,6 +172,7 @@ void TranslateTracker::finishBunch() {
 		_addedInBunch = -1;
 		applyLimit();
 		if (_trackingLanguage.current()) {
+			recognizeCollected();
 			checkRecognized();
 		}
 	}
@@ -336,11 +348,63 @@ void TranslateTracker::applyLimit() {
 }
 
 void TranslateTracker::recognizeCollected() {
-	for (auto &[id, entry] : _itemsForRecognize) {
+	if (_recognizing) {
+		return;
+	}
+	auto texts = std::vector<QString>();
+	auto list = std::vector<Recognized>();
+	for (const auto &[id, entry] : _itemsForRecognize) {
 		if (const auto text = std::get_if<QString>(&entry.id)) {
-			entry.id = Platform::Language::Recognize(*text);
+			texts.push_back(*text);
+			list.push_back({ .id = id, .textHash = entry.textHash });
+			if (list.size() == kMaxRecognizeInBatch) {
+				break;
+			}
+		}
+	}
+	if (list.empty()) {
+		return;
+	}
+	_recognizing = true;
+	crl::async([
+		=,
+		weak = base::make_weak(this),
+		texts = std::move(texts),
+		list = std::move(list)
+	]() mutable {
+		for (auto i = 0, count = int(list.size()); i != count; ++i) {
+			list[i].language = Platform::Language::Recognize(texts[i]);
+		}
+		crl::on_main(weak, [=, list = std::move(list)]() mutable {
+			recognizeDone(std::move(list));
+		});
+	});
+}
+
+void TranslateTracker::recognizeDone(std::vector<Recognized> &&list) {
+	_recognizing = false;
+	for (const auto &recognized : list) {
+		rememberRecognized(recognized.textHash, recognized.language);
+		const auto i = _itemsForRecognize.find(recognized.id);
+		if (i != end(_itemsForRecognize)
+			&& i->second.textHash == recognized.textHash
+			&& v::is<QString>(i->second.id)) {
+			i->second.id = recognized.language;
 		}
 	}
+	if (_trackingLanguage.current()) {
+		recognizeCollected();
+		checkRecognized();
+	}
+}
+
+void TranslateTracker::rememberRecognized(
+		uint64 textHash,
+		LanguageId language) {
+	if (_recognizedCache.size() >= kMaxRecognizedCached) {
+		_recognizedCache.clear();
+	}
+	_recognizedCache[textHash] = language;
 }
 
 void TranslateTracker::trackSkipLanguages() {
@@ -359,6 +423,10 @@ void TranslateTracker::checkRecognized(const std::vector<LanguageId> &skip) {
 		_history->translateOfferFrom({});
 		return;
 	}
+	if (_recognizing) {
+		// Wait for the whole collected set to be recognized.
+		return;
+	}
 	auto languages = base::flat_map<LanguageId, int>();
 	for (const auto &[id, entry] : _itemsForRecognize) {
 		if (const auto id = std::get_if<LanguageId>(&entry.id)) {
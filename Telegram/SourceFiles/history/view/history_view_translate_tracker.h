@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "base/weak_ptr.h"
 #include "spellcheck/spellcheck_types.h"
 
 class History;
@@ -16,7 +17,7 @@ namespace HistoryView {
 
 class Element;
 
-class TranslateTracker final {
+class TranslateTracker final : public base::has_weak_ptr {
 public:
 	explicit TranslateTracker(not_null<History*> history);
 	~TranslateTracker();
@@ -36,8 +37,14 @@ private:
 	using MaybeLanguageId = std::variant<QString, LanguageId>;
 	struct ItemForRecognize {
 		uint64 generation = 0;
+		uint64 textHash = 0;
 		MaybeLanguageId id;
 	};
+	struct Recognized {
+		FullMsgId id;
+		uint64 textHash = 0;
+		LanguageId language;
+	};
 	struct ItemToRequest {
 		int length = 0;
 	};
@@ -45,6 +52,8 @@ private:
 	void setup();
 	bool add(not_null<HistoryItem*> item, bool skipDependencies);
 	void recognizeCollected();
+	void recognizeDone(std::vector<Recognized> &&list);
+	void rememberRecognized(uint64 textHash, LanguageId language);
 	void trackSkipLanguages();
 	void checkRecognized();
 	void checkRecognized(const std::vector<LanguageId> &skip);
@@ -62,6 +71,8 @@ private:
 	rpl::variable<bool> _trackingLanguage = false;
 	base::flat_map<FullMsgId, ItemForRecognize> _itemsForRecognize;
 	uint64 _generation = 0;
+	base::flat_map<uint64, LanguageId> _recognizedCache;
+	bool _recognizing = false;
 	LanguageId _bunchTranslatedTo;
 	int _limit = 0;
 	int _addedInBunch = -1;
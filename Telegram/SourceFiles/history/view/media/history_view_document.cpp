@@ -639,7 +639,7 @@ void Document::draw(
 			Ui::PaintPatternBubblePart(
 				p,
 				context.viewport,
-				context.bubblesPattern->pixmap,
+				*context.bubblesPattern,
 				inner,
 				paintContent,
 				_iconCache);
@@ -846,6 +846,13 @@ bool Document::hasHeavyPart() const {
 	return (_dataMedia != nullptr);
 }
 
+void Document::preloadForDisplay() {
+	ensureDataMediaCreated();
+	if (!_dataMedia->canBePlayed(_realParent)) {
+		_dataMedia->automaticLoad(_realParent->fullId(), _realParent);
+	}
+}
+
 void Document::unloadHeavyPart() {
 	_dataMedia = nullptr;
 	if (const auto captioned = Get<HistoryDocumentCaptioned>()) {
@@ -928,7 +935,7 @@ void Document::drawCornerDownload(
 		Ui::PaintPatternBubblePart(
 			p,
 			context.viewport,
-			context.bubblesPattern->pixmap,
+			*context.bubblesPattern,
 			target,
 			paintContent,
 			_cornerDownloadCache);
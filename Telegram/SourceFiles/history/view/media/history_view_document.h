@@ -89,6 +89,7 @@ public:
 
 	bool hasHeavyPart() const override;
 	void unloadHeavyPart() override;
+	void preloadForDisplay() override;
 
 protected:
 	float64 dataProgress() const override;
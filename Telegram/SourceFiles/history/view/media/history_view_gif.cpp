@@ -1694,6 +1694,10 @@ bool Gif::hasHeavyPart() const {
 	return (_spoiler && _spoiler->animation) || _streamed || _dataMedia;
 }
 
+void Gif::preloadForDisplay() {
+	ensureDataMediaCreated();
+}
+
 void Gif::unloadHeavyPart() {
 	stopAnimation();
 	_dataMedia = nullptr;
@@ -119,6 +119,7 @@ public:
 
 	bool hasHeavyPart() const override;
 	void unloadHeavyPart() override;
+	void preloadForDisplay() override;
 
 	void refreshParentId(not_null<HistoryItem*> realParent) override;
 
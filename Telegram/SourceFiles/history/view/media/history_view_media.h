@@ -322,6 +322,10 @@ public:
 	virtual void unloadHeavyPart() {
 	}
 
+	// Request thumbnails and automatic downloads before the first paint.
+	virtual void preloadForDisplay() {
+	}
+
 	// Should be called only by Data::Session.
 	virtual void updateSharedContactUserId(UserId userId) {
 	}
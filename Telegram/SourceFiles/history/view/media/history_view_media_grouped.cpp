@@ -751,6 +751,12 @@ bool GroupedMedia::hasHeavyPart() const {
 	return false;
 }
 
+void GroupedMedia::preloadForDisplay() {
+	for (const auto &part : _parts) {
+		part.content->preloadForDisplay();
+	}
+}
+
 void GroupedMedia::unloadHeavyPart() {
 	for (const auto &part : _parts) {
 		part.content->unloadHeavyPart();
@@ -98,6 +98,7 @@ public:
 	void checkAnimation() override;
 	bool hasHeavyPart() const override;
 	void unloadHeavyPart() override;
+	void preloadForDisplay() override;
 
 	void parentTextUpdated() override;
 
@@ -49,6 +49,8 @@ public:
 		}
 		virtual void unloadHeavyPart() {
 		}
+		virtual void preloadForDisplay() {
+		}
 		virtual void refreshLink() {
 		}
 		[[nodiscard]] virtual bool alwaysShowOutTimestamp() {
@@ -110,6 +112,9 @@ public:
 	void unloadHeavyPart() override {
 		_content->unloadHeavyPart();
 	}
+	void preloadForDisplay() override {
+		_content->preloadForDisplay();
+	}
 
 private:
 	struct SurroundingInfo {
@@ -154,6 +154,11 @@ bool Photo::hasHeavyPart() const {
 	return (_spoiler && _spoiler->animation) || _streamed || _dataMedia;
 }
 
+void Photo::preloadForDisplay() {
+	ensureDataMediaCreated();
+	_dataMedia->automaticLoad(_realParent->fullId(), _parent->data());
+}
+
 void Photo::unloadHeavyPart() {
 	stopAnimation();
 	_dataMedia = nullptr;
@@ -909,7 +909,7 @@ void Poll::paintRecentVoters(
 			Ui::PaintPatternBubblePart(
 				p,
 				context.viewport,
-				context.bubblesPattern->pixmap,
+				*context.bubblesPattern,
 				target,
 				paintContent,
 				_userpicCircleCache);
@@ -1270,7 +1270,7 @@ void Poll::paintFilling(
 			Ui::PaintPatternBubblePart(
 				p,
 				context.viewport,
-				context.bubblesPattern->pixmap,
+				*context.bubblesPattern,
 				target,
 				paintContent,
 				_fillingIconCache);
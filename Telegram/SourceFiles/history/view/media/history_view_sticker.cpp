@@ -560,6 +560,15 @@ bool Sticker::hasHeavyPart() const {
 	return _player || _dataMedia;
 }
 
+void Sticker::preloadForDisplay() {
+	// Only load the file, the player is created when it gets painted,
+	// otherwise the premium effect would be started off-screen.
+	if (_data->sticker()) {
+		ensureDataMediaCreated();
+		_dataMedia->checkStickerLarge();
+	}
+}
+
 void Sticker::unloadHeavyPart() {
 	unloadPlayer();
 	_dataMedia = nullptr;
@@ -59,6 +59,7 @@ public:
 
 	bool hasHeavyPart() const override;
 	void unloadHeavyPart() override;
+	void preloadForDisplay() override;
 
 	void refreshLink() override;
 	bool hasTextForCopy() const override {
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lang/lang_instance.h"
 
 #include "core/application.h"
+#include "core/version.h"
 #include "storage/serialize_common.h"
 #include "storage/localstorage.h"
 #include "ui/boxes/confirm_box.h"
@@ -22,7 +23,9 @@ namespace Lang {
 namespace {
 
 const auto kSerializeVersionTag = u"#new"_q;
-constexpr auto kSerializeVersion = 1;
+constexpr auto kSerializeVersion = 3;
+constexpr auto kSerializeVersionParsedByIndex = 2;
+constexpr auto kSerializeVersionNoParsed = 1;
 constexpr auto kCloudLangPackName = "tdesktop"_cs;
 constexpr auto kCustomLanguage = "#custom"_cs;
 constexpr auto kLangValuesLimit = 20000;
@@ -213,6 +216,58 @@ void ParseKeyValue(
 	}
 }
 
+struct ParsedValue {
+	int position = 0;
+	QStringView value;
+	bool failed = false;
+};
+
+struct ParsedValues {
+	QString pool;
+	std::vector<ParsedValue> entries;
+};
+
+[[nodiscard]] std::optional<ParsedValues> DeserializeParsedValues(
+		const QByteArray &data,
+		int valuesCount) {
+	QDataStream stream(data);
+	stream.setVersion(QDataStream::Qt_5_1);
+	auto appVersion = qint32();
+	auto result = ParsedValues();
+	auto count = qint32();
+	stream >> appVersion >> result.pool >> count;
+	if (stream.status() != QDataStream::Ok
+		|| appVersion != AppVersion
+		|| count < 0
+		|| count > valuesCount) {
+		return std::nullopt;
+	}
+	const auto pool = QStringView(result.pool);
+	result.entries.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		auto position = qint32();
+		auto offset = qint32();
+		auto length = qint32();
+		stream >> position >> offset >> length;
+		if (stream.status() != QDataStream::Ok
+			|| position >= valuesCount
+			|| (!result.entries.empty()
+				&& position <= result.entries.back().position)
+			|| offset < -1
+			|| length < 0
+			|| offset > pool.size() - length) {
+			return std::nullopt;
+		}
+		result.entries.push_back(offset < 0
+			? ParsedValue{ .position = position, .failed = true }
+			: ParsedValue{
+				.position = position,
+				.value = pool.mid(offset, length),
+			});
+	}
+	return result;
+}
+
 } // namespace
 
 QString CloudLangPackName() {
@@ -238,12 +293,14 @@ struct Instance::PrivateTag {
 
 Instance::Instance()
 : _values(PrepareDefaultValues())
-, _nonDefaultSet(kKeysCount, 0) {
+, _nonDefaultSet(kKeysCount, 0)
+, _nonDefaultParsed(kKeysCount) {
 }
 
 Instance::Instance(not_null<Instance*> derived, const PrivateTag &)
 : _derived(derived)
-, _nonDefaultSet(kKeysCount, 0) {
+, _nonDefaultSet(kKeysCount, 0)
+, _nonDefaultParsed(kKeysCount) {
 }
 
 void Instance::switchToId(const Language &data) {
@@ -298,6 +355,7 @@ void Instance::reset(const Language &data) {
 		_values[i] = GetOriginalValue(ushort(i));
 	}
 	ranges::fill(_nonDefaultSet, 0);
+	ranges::fill(_nonDefaultParsed, QString());
 	updateChoosingStickerReplacement();
 
 	_idChanges.fire_copy(_id);
@@ -393,6 +451,8 @@ QByteArray Instance::serialize() const {
 	}
 	const auto base = _base ? _base->serialize() : QByteArray();
 	size += Serialize::bytearraySize(base);
+	const auto parsed = serializeParsedValues();
+	size += Serialize::bytearraySize(parsed);
 
 	auto result = QByteArray();
 	result.reserve(size);
@@ -414,7 +474,48 @@ QByteArray Instance::serialize() const {
 		for (const auto &nonDefault : _nonDefaultValues) {
 			stream << nonDefault.first << nonDefault.second;
 		}
-		stream << base;
+		stream << base << parsed;
+	}
+	return result;
+}
+
+// Parsed values are stored as one UTF-16 pool with an offset table that
+// refers to the raw values by their position, so key indices are looked up
+// by name on load. Only values that differ from their plain UTF-8 text go
+// to the pool, the rest are decoded without running the parser. The pool
+// depends on the tags layout of the build, so it is checked by app version.
+QByteArray Instance::serializeParsedValues() const {
+	auto pool = QString();
+	auto table = std::vector<std::tuple<int, int, int>>();
+	auto position = 0;
+	for (const auto &[key, value] : _nonDefaultValues) {
+		const auto index = GetKeyIndex(QLatin1String(key));
+		if (index != kKeysCount) {
+			const auto &parsed = _nonDefaultParsed[index];
+			if (!_nonDefaultSet[index]) {
+				table.emplace_back(position, -1, 0);
+			} else if (parsed != QString::fromUtf8(value)) {
+				table.emplace_back(
+					position,
+					int(pool.size()),
+					int(parsed.size()));
+				pool.append(parsed);
+			}
+		}
+		++position;
+	}
+
+	auto result = QByteArray();
+	result.reserve(sizeof(qint32) * 2
+		+ Serialize::stringSize(pool)
+		+ table.size() * sizeof(qint32) * 3);
+	{
+		QDataStream stream(&result, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_1);
+		stream << qint32(AppVersion) << pool << qint32(table.size());
+		for (const auto &[position, offset, length] : table) {
+			stream << qint32(position) << qint32(offset) << qint32(length);
+		}
 	}
 	return result;
 }
@@ -443,7 +544,9 @@ void Instance::fillFromSerialized(
 			>> nonDefaultValuesCount;
 	} else {
 		stream >> serializeVersion;
-		if (serializeVersion == kSerializeVersion) {
+		if (serializeVersion == kSerializeVersion
+			|| serializeVersion == kSerializeVersionParsedByIndex
+			|| serializeVersion == kSerializeVersionNoParsed) {
 			stream
 				>> id
 				>> pluralId
@@ -522,6 +625,17 @@ void Instance::fillFromSerialized(
 	} else {
 		stream >> base;
 	}
+	auto parsed = std::optional<ParsedValues>();
+	if (serializeVersion == kSerializeVersion
+		&& dataAppVersion == AppVersion) {
+		auto serialized = QByteArray();
+		stream >> serialized;
+		if (stream.status() == QDataStream::Ok) {
+			parsed = DeserializeParsedValues(
+				serialized,
+				nonDefaultValuesCount);
+		}
+	}
 	if (!base.isEmpty()) {
 		_base = std::make_unique<Instance>(this, PrivateTag{});
 		_base->fillFromSerialized(base, dataAppVersion);
@@ -540,8 +654,29 @@ void Instance::fillFromSerialized(
 	_customFilePathRelative = customFilePathRelative;
 	_customFileContent = customFileContent;
 	LOG(("Lang Info: Loaded cached, keys: %1").arg(nonDefaultValuesCount));
-	for (auto i = 0, count = nonDefaultValuesCount * 2; i != count; i += 2) {
-		applyValue(nonDefaultStrings[i], nonDefaultStrings[i + 1]);
+	if (parsed) {
+		auto entry = begin(parsed->entries);
+		for (auto i = 0; i != nonDefaultValuesCount; ++i) {
+			auto &key = nonDefaultStrings[i * 2];
+			auto &value = nonDefaultStrings[i * 2 + 1];
+			const auto index = GetKeyIndex(QLatin1String(key));
+			if (entry != end(parsed->entries) && entry->position == i) {
+				if (!entry->failed && index != kKeysCount) {
+					applyParsedValue(index, entry->value.toString());
+				}
+				++entry;
+			} else if (index != kKeysCount) {
+				applyParsedValue(index, QString::fromUtf8(value));
+			}
+			_nonDefaultValues.insert_or_assign(
+				end(_nonDefaultValues),
+				std::move(key),
+				std::move(value));
+		}
+	} else {
+		for (auto i = 0, count = nonDefaultValuesCount * 2; i != count; i += 2) {
+			applyValue(nonDefaultStrings[i], nonDefaultStrings[i + 1]);
+		}
 	}
 	updatePluralRules();
 	updateChoosingStickerReplacement();
@@ -730,28 +865,33 @@ QString Instance::getNonDefaultValue(const QByteArray &key) const {
 void Instance::applyValue(const QByteArray &key, const QByteArray &value) {
 	_nonDefaultValues[key] = value;
 	ParseKeyValue(key, value, [&](ushort key, QString &&value) {
-		_nonDefaultSet[key] = 1;
-		if (!_derived) {
-			if (ranges::contains(tr::hasTelegram, key)) {
-				auto v = std::move(value);
-				_values[key] = v.replace(
-					QRegularExpression("Telegram"),
-					kCustomBrand.utf16());
-				return;
-			}
-			_values[key] = std::move(value);
-		} else if (!_derived->_nonDefaultSet[key]) {
-			_derived->_values[key] = std::move(value);
+		applyParsedValue(key, std::move(value));
+	});
+}
+
+void Instance::applyParsedValue(ushort key, QString &&value) {
+	_nonDefaultSet[key] = 1;
+	_nonDefaultParsed[key] = value;
+	if (!_derived) {
+		if (ranges::contains(tr::hasTelegram, key)) {
+			auto v = std::move(value);
+			_values[key] = v.replace(
+				QRegularExpression("Telegram"),
+				kCustomBrand.utf16());
+			return;
 		}
-		if (key == tr::lng_send_action_choose_sticker.base
-			|| key == tr::lng_user_action_choose_sticker.base) {
-			if (!_derived) {
-				updateChoosingStickerReplacement();
-			} else {
-				_derived->updateChoosingStickerReplacement();
-			}
+		_values[key] = std::move(value);
+	} else if (!_derived->_nonDefaultSet[key]) {
+		_derived->_values[key] = std::move(value);
+	}
+	if (key == tr::lng_send_action_choose_sticker.base
+		|| key == tr::lng_user_action_choose_sticker.base) {
+		if (!_derived) {
+			updateChoosingStickerReplacement();
+		} else {
+			_derived->updateChoosingStickerReplacement();
 		}
-	});
+	}
 }
 
 void Instance::updatePluralRules() {
@@ -771,6 +911,7 @@ void Instance::resetValue(const QByteArray &key) {
 	const auto keyIndex = GetKeyIndex(QLatin1String(key));
 	if (keyIndex != kKeysCount) {
 		_nonDefaultSet[keyIndex] = 0;
+		_nonDefaultParsed[keyIndex] = QString();
 		if (!_derived) {
 			const auto base = _base
 				? _base->getNonDefaultValue(key)
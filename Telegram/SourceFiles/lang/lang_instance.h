@@ -110,7 +110,9 @@ private:
 
 	void applyDifferenceToMe(const MTPDlangPackDifference &difference);
 	void applyValue(const QByteArray &key, const QByteArray &value);
+	void applyParsedValue(ushort key, QString &&value);
 	void resetValue(const QByteArray &key);
+	[[nodiscard]] QByteArray serializeParsedValues() const;
 	void reset(const Language &language);
 	void fillFromCustomContent(
 		const QString &absolutePath,
@@ -146,6 +148,7 @@ private:
 
 	std::vector<QString> _values;
 	std::vector<uchar> _nonDefaultSet;
+	std::vector<QString> _nonDefaultParsed;
 	std::map<QByteArray, QByteArray> _nonDefaultValues;
 
 	std::unique_ptr<Instance> _base;
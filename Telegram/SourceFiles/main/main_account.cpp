@@ -25,6 +25,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtp_instance.h"
 #include "ui/image/image.h"
 #include "mainwidget.h"
+#include "apiwrap.h"
 #include "api/api_updates.h"
 #include "main/main_app_config.h"
 #include "main/main_session.h"
@@ -57,6 +58,7 @@ Account::Account(not_null<Domain*> domain, const QString &dataName, int index)
 Account::~Account() {
 	if (const auto session = maybeSession()) {
 		session->saveSettingsNowIfNeeded();
+		local().writePeers(session->data().peersForLocalCache());
 	}
 	destroySession(DestroyReason::Quitting);
 }
@@ -191,6 +193,8 @@ void Account::createSession(
 	if (!serialized.isEmpty()) {
 		local().readSelf(_session.get(), serialized, streamVersion);
 	}
+	local().readPeers(_session.get());
+	_session->api().applyDialogsSnapshot();
 	_sessionValue = _session.get();
 
 	Ensures(_session != nullptr);
@@ -35,7 +35,6 @@ namespace {
 
 constexpr auto kSuppressRatioAll = 0.2;
 constexpr auto kSuppressRatioSong = 0.05;
-constexpr auto kWaveformCounterBufferSize = 256 * 1024;
 constexpr auto kEffectDestructionDelay = crl::time(1000);
 
 QMutex AudioMutex;
@@ -280,6 +279,53 @@ bool SupportsSpeedControl() {
 	return result;
 }
 
+uint16 MaxSample(gsl::span<const uchar> samples) {
+	// Plain loops over contiguous data for the compiler to vectorize.
+	auto result = 0;
+	for (const auto sample : samples) {
+		const auto value = int(sample) - 0x80;
+		result = std::max(result, (value < 0) ? -value : value);
+	}
+	return uint16(result * 0x100);
+}
+
+uint16 MaxSample(gsl::span<const int16> samples) {
+	auto result = 0;
+	for (const auto sample : samples) {
+		const auto value = int(sample);
+		result = std::max(result, (value < 0) ? -value : value);
+	}
+	return uint16(result);
+}
+
+WaveformBuilder::WaveformBuilder(int64 total, int pointsCount)
+: _total(total)
+, _pointsCount(pointsCount) {
+	Expects(_pointsCount > 0);
+
+	_peaks.reserve(_pointsCount);
+}
+
+VoiceWaveform WaveformBuilder::finish() {
+	if (_sum > 0 && int(_peaks.size()) < _pointsCount) {
+		_peaks.push_back(_peak);
+	}
+	if (_peaks.empty()) {
+		return VoiceWaveform();
+	}
+
+	const auto sum = std::accumulate(_peaks.cbegin(), _peaks.cend(), 0LL);
+	const auto peak = qMax(int32(sum * 1.8 / _peaks.size()), 2500);
+
+	auto result = VoiceWaveform(_peaks.size());
+	for (auto i = 0, l = int(_peaks.size()); i != l; ++i) {
+		result[i] = char(qMin(
+			31U,
+			uint32(qMin(int32(_peaks[i]), peak)) * 31 / peak));
+	}
+	return result;
+}
+
 } // namespace Audio
 
 namespace Player {
@@ -1594,30 +1640,17 @@ public:
 			return false;
 		}
 
-		QByteArray buffer;
-		buffer.reserve(kWaveformCounterBufferSize);
 		const auto samplesCount = samplesFrequency() * duration() / 1000;
-		int64 countbytes = sampleSize() * samplesCount;
-		int64 processed = 0;
-		int64 sumbytes = 0;
+		const auto countbytes = int64(sampleSize()) * samplesCount;
 		if (samplesCount < Media::Player::kWaveformSamplesCount) {
 			return false;
 		}
 
-		QVector<uint16> peaks;
-		peaks.reserve(Media::Player::kWaveformSamplesCount);
-
-		auto fmt = format();
-		auto peak = uint16(0);
-		auto callback = [&](uint16 sample) {
-			accumulate_max(peak, sample);
-			sumbytes += Media::Player::kWaveformSamplesCount;
-			if (sumbytes >= countbytes) {
-				sumbytes -= countbytes;
-				peaks.push_back(peak);
-				peak = 0;
-			}
-		};
+		auto builder = Media::Audio::WaveformBuilder(
+			countbytes,
+			Media::Player::kWaveformSamplesCount);
+		const auto fmt = format();
+		auto processed = int64(0);
 		while (processed < countbytes) {
 			const auto result = readMore();
 			Assert(result != ReadError::Wait); // Not a child loader.
@@ -1631,29 +1664,14 @@ public:
 			const auto sampleBytes = v::get<bytes::const_span>(result);
 			Assert(!sampleBytes.empty());
 			if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
-				Media::Audio::IterateSamples<uchar>(sampleBytes, callback);
+				builder.add<uchar>(sampleBytes);
 			} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
-				Media::Audio::IterateSamples<int16>(sampleBytes, callback);
+				builder.add<int16>(sampleBytes);
 			}
 			processed += sampleBytes.size();
 		}
-		if (sumbytes > 0 && peaks.size() < Media::Player::kWaveformSamplesCount) {
-			peaks.push_back(peak);
-		}
-
-		if (peaks.isEmpty()) {
-			return false;
-		}
-
-		auto sum = std::accumulate(peaks.cbegin(), peaks.cend(), 0LL);
-		peak = qMax(int32(sum * 1.8 / peaks.size()), 2500);
-
-		result.resize(peaks.size());
-		for (int32 i = 0, l = peaks.size(); i != l; ++i) {
-			result[i] = char(qMin(31U, uint32(qMin(peaks.at(i), peak)) * 31 / peak));
-		}
-
-		return true;
+		result = builder.finish();
+		return !result.isEmpty();
 	}
 
 	const VoiceWaveform &waveform() const {
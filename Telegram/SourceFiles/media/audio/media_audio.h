@@ -415,5 +415,53 @@ void IterateSamples(bytes::const_span bytes, Callback &&callback) {
 	}
 }
 
+[[nodiscard]] uint16 MaxSample(gsl::span<const uchar> samples);
+[[nodiscard]] uint16 MaxSample(gsl::span<const int16> samples);
+
+// Collects waveform peaks from decoded samples chunk by chunk, taking
+// the maximum of each run of samples between two points at once.
+class WaveformBuilder final {
+public:
+	WaveformBuilder(int64 total, int pointsCount);
+
+	template <typename SampleType>
+	void add(bytes::const_span bytes) {
+		const auto samples = gsl::make_span(
+			reinterpret_cast<const SampleType*>(bytes.data()),
+			bytes.size() / sizeof(SampleType));
+		addRuns(samples.size(), [&](int64 from, int64 count) {
+			return MaxSample(samples.subspan(from, count));
+		});
+	}
+
+	[[nodiscard]] VoiceWaveform finish();
+
+private:
+	template <typename MaxInRun>
+	void addRuns(int64 size, MaxInRun &&maxInRun) {
+		for (auto from = int64(0); from < size;) {
+			const auto left = _total - _sum;
+			const auto tillPoint = (left > 0)
+				? ((left + _pointsCount - 1) / _pointsCount)
+				: 1;
+			const auto count = std::min(tillPoint, size - from);
+			accumulate_max(_peak, maxInRun(from, count));
+			_sum += _pointsCount * count;
+			from += count;
+			if (_sum >= _total) {
+				_sum -= _total;
+				_peaks.push_back(base::take(_peak));
+			}
+		}
+	}
+
+	const int64 _total = 0;
+	const int _pointsCount = 0;
+	int64 _sum = 0;
+	uint16 _peak = 0;
+	std::vector<uint16> _peaks;
+
+};
+
 } // namespace Audio
 } // namespace Media
@@ -21,6 +21,14 @@ namespace {
 
 constexpr auto kHeaderSize = 8;
 constexpr auto kFindMoovBefore = 128 * 1024;
+constexpr auto kMaxMoovSize = 64 * 1024 * 1024;
+constexpr auto kCopyChunkSize = 1024 * 1024;
+
+struct Atom {
+	QByteArray type;
+	int64 offset = 0;
+	int64 size = 0;
+};
 
 template <typename Type>
 Type ReadBigEndian(bytes::const_span data) {
@@ -34,6 +42,176 @@ bool IsAtom(bytes::const_span header, const char (&atom)[5]) {
 		bytes::make_span(atom).subspan(0, 4)) == 0;
 }
 
+template <typename Type>
+void WriteBigEndian(bytes::span data, Type value) {
+	const auto converted = qToBigEndian(value);
+	memcpy(data.data(), &converted, sizeof(Type));
+}
+
+[[nodiscard]] std::vector<Atom> ReadTopLevelAtoms(
+		not_null<QIODevice*> device,
+		int64 size) {
+	auto result = std::vector<Atom>();
+	auto position = int64(0);
+	char atomHeader[kHeaderSize] = { 0 };
+	auto atomHeaderBytes = bytes::make_span(atomHeader);
+	while (position < size) {
+		if (!device->seek(position)
+			|| device->read(atomHeader, kHeaderSize) != kHeaderSize) {
+			return {};
+		}
+		auto length = int64(ReadBigEndian<uint32>(atomHeaderBytes));
+		if (length == 1) {
+			char atomSize64[kHeaderSize] = { 0 };
+			if (device->read(atomSize64, kHeaderSize) != kHeaderSize) {
+				return {};
+			}
+			length = int64(ReadBigEndian<uint64>(bytes::make_span(atomSize64)));
+		} else if (!length) {
+			length = size - position;
+		}
+		if (length < kHeaderSize || position + length > size) {
+			return {};
+		}
+		result.push_back({
+			.type = QByteArray(atomHeader + 4, 4),
+			.offset = position,
+			.size = length,
+		});
+		position += length;
+	}
+	return result;
+}
+
+// Shift chunk offsets of the data placed between 'ftyp' and 'moov'.
+[[nodiscard]] bool PatchChunkOffsets(
+		bytes::span data,
+		int64 from,
+		int64 till,
+		int64 shift) {
+	const auto patched = [&](uint64 offset) {
+		return (offset >= uint64(from) && offset < uint64(till))
+			? (offset + shift)
+			: offset;
+	};
+	while (!data.empty()) {
+		if (data.size() < kHeaderSize) {
+			return false;
+		}
+		const auto length = uint64(ReadBigEndian<uint32>(data));
+		const auto header = bytes::const_span(data.subspan(0, kHeaderSize));
+		if (length < kHeaderSize || length > data.size()) {
+			// Large atoms inside 'moov' are not supported here.
+			return false;
+		}
+		const auto body = data.subspan(kHeaderSize, length - kHeaderSize);
+		if (IsAtom(header, "trak")
+			|| IsAtom(header, "mdia")
+			|| IsAtom(header, "minf")
+			|| IsAtom(header, "stbl")) {
+			if (!PatchChunkOffsets(body, from, till, shift)) {
+				return false;
+			}
+		} else if (IsAtom(header, "cmov")) {
+			return false;
+		} else if (IsAtom(header, "stco") || IsAtom(header, "co64")) {
+			const auto wide = IsAtom(header, "co64");
+			const auto entrySize = wide ? 8 : 4;
+			if (body.size() < 8) {
+				return false;
+			}
+			const auto count = ReadBigEndian<uint32>(body.subspan(4));
+			if (uint64(body.size() - 8) < uint64(count) * entrySize) {
+				return false;
+			}
+			auto entries = body.subspan(8);
+			for (auto i = uint32(); i != count; ++i) {
+				const auto entry = entries.subspan(i * entrySize, entrySize);
+				if (wide) {
+					WriteBigEndian(entry, patched(ReadBigEndian<uint64>(entry)));
+				} else {
+					const auto value = patched(ReadBigEndian<uint32>(entry));
+					if (value > std::numeric_limits<uint32>::max()) {
+						return false;
+					}
+					WriteBigEndian(entry, uint32(value));
+				}
+			}
+		}
+		data = data.subspan(length);
+	}
+	return true;
+}
+
+[[nodiscard]] bool CopyRange(
+		not_null<QIODevice*> input,
+		not_null<QIODevice*> output,
+		int64 offset,
+		int64 size) {
+	if (!input->seek(offset)) {
+		return false;
+	}
+	auto buffer = QByteArray(
+		int(std::min(size, int64(kCopyChunkSize))),
+		Qt::Uninitialized);
+	while (size > 0) {
+		const auto chunk = std::min(size, int64(buffer.size()));
+		if (input->read(buffer.data(), chunk) != chunk
+			|| output->write(buffer.constData(), chunk) != chunk) {
+			return false;
+		}
+		size -= chunk;
+	}
+	return true;
+}
+
+[[nodiscard]] bool MakeStreamable(
+		not_null<QIODevice*> input,
+		int64 size,
+		not_null<QIODevice*> output) {
+	const auto atoms = ReadTopLevelAtoms(input, size);
+	if (atoms.empty() || atoms.front().type != "ftyp") {
+		return false;
+	}
+	const auto moov = ranges::find(atoms, "moov", &Atom::type);
+	const auto mdat = ranges::find(atoms, "mdat", &Atom::type);
+	if (moov == end(atoms)
+		|| mdat == end(atoms)
+		|| moov < mdat
+		|| moov->size > kMaxMoovSize
+		|| ranges::contains(atoms, "moof", &Atom::type)
+		|| ranges::count(atoms, "moov", &Atom::type) != 1) {
+		return false;
+	}
+	auto moovData = QByteArray(int(moov->size), Qt::Uninitialized);
+	if (!input->seek(moov->offset)
+		|| input->read(moovData.data(), moov->size) != moov->size) {
+		return false;
+	}
+	const auto ftyp = atoms.front();
+	auto moovBytes = bytes::make_span(moovData);
+	const auto moovHeaderSize = (ReadBigEndian<uint32>(moovBytes) == 1)
+		? 2 * kHeaderSize
+		: kHeaderSize;
+	if (!PatchChunkOffsets(
+			moovBytes.subspan(moovHeaderSize),
+			ftyp.offset + ftyp.size,
+			moov->offset,
+			moov->size)) {
+		return false;
+	}
+	if (!CopyRange(input, output, ftyp.offset, ftyp.size)
+		|| output->write(moovData) != moov->size) {
+		return false;
+	}
+	for (auto i = begin(atoms) + 1; i != end(atoms); ++i) {
+		if (i != moov && !CopyRange(input, output, i->offset, i->size)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 } // namespace
 
 bool CheckStreamingSupport(
@@ -93,5 +271,35 @@ bool CheckStreamingSupport(
 	return false;
 }
 
+bool MakeStreamable(const QString &path, const QString &resultPath) {
+	auto input = QFile(path);
+	if (!input.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	auto output = QFile(resultPath);
+	if (!output.open(QIODevice::WriteOnly)) {
+		LOG(("Clip Error: Could not open '%1' for writing.").arg(resultPath));
+		return false;
+	} else if (!MakeStreamable(&input, input.size(), &output)) {
+		output.close();
+		output.remove();
+		return false;
+	}
+	return true;
+}
+
+QByteArray MakeStreamable(QByteArray data) {
+	auto input = QBuffer(&data);
+	auto result = QByteArray();
+	result.reserve(data.size());
+	auto output = QBuffer(&result);
+	if (!input.open(QIODevice::ReadOnly)
+		|| !output.open(QIODevice::WriteOnly)
+		|| !MakeStreamable(&input, data.size(), &output)) {
+		return QByteArray();
+	}
+	return result;
+}
+
 } // namespace Clip
 } // namespace Media
@@ -18,5 +18,12 @@ bool CheckStreamingSupport(
 	const Core::FileLocation &location,
 	QByteArray data);
 
+// Moves 'moov' atom of an MP4 file right after 'ftyp', without
+// re-encoding, so that the file can be played while downloading.
+[[nodiscard]] bool MakeStreamable(
+	const QString &path,
+	const QString &resultPath);
+[[nodiscard]] QByteArray MakeStreamable(QByteArray data);
+
 } // namespace Clip
 } // namespace Media
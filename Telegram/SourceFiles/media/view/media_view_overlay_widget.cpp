@@ -22,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/popup_menu.h"
 #include "ui/widgets/buttons.h"
 #include "ui/image/image.h"
+#include "ui/image/image_prepare.h"
 #include "ui/layers/layer_manager.h"
 #include "ui/text/text_utilities.h"
 #include "ui/platform/ui_platform_utility.h"
@@ -112,6 +113,9 @@ namespace View {
 namespace {
 
 constexpr auto kPreloadCount = 3;
+constexpr auto kPreloadMaxCount = 12;
+constexpr auto kPreloadFastMoveTimeout = crl::time(600);
+constexpr auto kPreparedPhotosBytesLimit = 96 * 1024 * 1024;
 constexpr auto kMaxZoomLevel = 7; // x8
 constexpr auto kZoomToScreenLevel = 1024;
 constexpr auto kOverlayLoaderPriority = 2;
@@ -4325,6 +4329,13 @@ void OverlayWidget::validatePhotoImage(Image *image, bool blurred) {
 	}
 	const auto use = flipSizeByRotation({ _width, _height })
 		* cIntRetinaFactor();
+	if (!blurred) {
+		if (auto prepared = takePreparedPhoto(use); !prepared.isNull()) {
+			setStaticContent(std::move(prepared));
+			_blurred = false;
+			return;
+		}
+	}
 	setStaticContent(image->pixNoCache(
 		use,
 		{ .options = (blurred ? Images::Option::Blur : Images::Option()) }
@@ -5208,6 +5219,7 @@ void OverlayWidget::setSession(not_null<Main::Session*> session) {
 		if (!isHidden()) {
 			updateControls();
 			checkForSaveLoaded();
+			preparePreloadedPhotos();
 		}
 	}, _sessionLifetime);
 
@@ -5276,7 +5288,7 @@ void OverlayWidget::preloadData(int delta) {
 		return;
 	}
 	auto from = *_index + (delta ? -delta : -1);
-	auto till = *_index + (delta ? delta * kPreloadCount : 1);
+	auto till = *_index + (delta ? delta * preloadCount(delta) : 1);
 	if (from > till) std::swap(from, till);
 
 	auto photos = base::flat_set<std::shared_ptr<Data::PhotoMedia>>();
@@ -5299,6 +5311,101 @@ void OverlayWidget::preloadData(int delta) {
 	}
 	_preloadPhotos = std::move(photos);
 	_preloadDocuments = std::move(documents);
+
+	// The current photo keeps its prepared image until it is painted.
+	for (auto i = begin(_preparedPhotos); i != end(_preparedPhotos);) {
+		const auto photo = i->first;
+		const auto preloaded = ranges::contains(
+			_preloadPhotos,
+			photo,
+			&Data::PhotoMedia::owner);
+		if (preloaded || photo == _photo) {
+			++i;
+		} else {
+			i = _preparedPhotos.erase(i);
+		}
+	}
+	preparePreloadedPhotos();
+}
+
+int OverlayWidget::preloadCount(int delta) {
+	// Grow the window while the user keeps flipping in one direction.
+	const auto now = crl::now();
+	if (delta == _preloadDelta
+		&& now - _preloadLastMove < kPreloadFastMoveTimeout) {
+		_preloadStreak = std::min(
+			_preloadStreak + 1,
+			kPreloadMaxCount - kPreloadCount);
+	} else {
+		_preloadStreak = 0;
+	}
+	_preloadDelta = delta;
+	_preloadLastMove = now;
+	return kPreloadCount + _preloadStreak;
+}
+
+void OverlayWidget::preparePreloadedPhotos() {
+	auto bytes = int64();
+	for (const auto &[photo, prepared] : _preparedPhotos) {
+		bytes += int64(prepared.size.width()) * prepared.size.height() * 4;
+	}
+	for (const auto &media : _preloadPhotos) {
+		const auto photo = media->owner();
+		if (photo == _photo
+			|| _preparedPhotos.contains(photo)
+			|| photo->videoCanBePlayed()) {
+			continue;
+		}
+		const auto large = media->image(Data::PhotoSize::Large);
+		if (!large) {
+			continue;
+		}
+		const auto rotation = photo->owner().mediaRotation().get(photo);
+		const auto size = style::ConvertScale(FlipSizeByRotation(
+			QSize(photo->width(), photo->height()),
+			rotation));
+		const auto use = FlipSizeByRotation(size, rotation)
+			* cIntRetinaFactor();
+		const auto add = int64(use.width()) * use.height() * 4;
+		if (use.isEmpty() || bytes + add > kPreparedPhotosBytesLimit) {
+			continue;
+		}
+		bytes += add;
+		_preparedPhotos.emplace(photo, PreparedPhoto{ .size = use });
+		const auto weak = Ui::MakeWeak(_widget);
+		crl::async([=, original = large->original()] {
+			auto image = Images::Prepare(original, use, {});
+			crl::on_main([=, image = std::move(image)]() mutable {
+				if (weak) {
+					preparedPhotoReady(photo, use, std::move(image));
+				}
+			});
+		});
+	}
+}
+
+void OverlayWidget::preparedPhotoReady(
+		not_null<PhotoData*> photo,
+		QSize size,
+		QImage image) {
+	const auto i = _preparedPhotos.find(photo);
+	if (i != end(_preparedPhotos)
+		&& i->second.size == size
+		&& i->second.image.isNull()) {
+		i->second.image = std::move(image);
+	}
+}
+
+QImage OverlayWidget::takePreparedPhoto(QSize size) {
+	const auto i = _photo ? _preparedPhotos.find(_photo) : end(_preparedPhotos);
+	if (i == end(_preparedPhotos)) {
+		return QImage();
+	}
+	auto result = (i->second.size == size)
+		? std::move(i->second.image)
+		: QImage();
+	_preparedPhotos.erase(i);
+	return result;
 }
 
 void OverlayWidget::handleMousePress(
@@ -5928,6 +6035,7 @@ void OverlayWidget::clearBeforeHide() {
 	assignMediaPointer(nullptr);
 	_preloadPhotos.clear();
 	_preloadDocuments.clear();
+	_preparedPhotos.clear();
 	if (_menu) {
 		_menu->hideMenu(true);
 	}
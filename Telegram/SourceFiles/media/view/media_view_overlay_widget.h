@@ -135,6 +135,10 @@ public:
 private:
 	class Show;
 	struct Streamed;
+	struct PreparedPhoto {
+		QSize size;
+		QImage image;
+	};
 	struct PipWrap;
 	struct ItemContext;
 	struct StoriesContext;
@@ -304,6 +308,13 @@ private:
 	void updateGeometryToScreen(bool inMove = false);
 	bool moveToNext(int delta);
 	void preloadData(int delta);
+	[[nodiscard]] int preloadCount(int delta);
+	void preparePreloadedPhotos();
+	void preparedPhotoReady(
+		not_null<PhotoData*> photo,
+		QSize size,
+		QImage image);
+	[[nodiscard]] QImage takePreparedPhoto(QSize size);
 
 	void handleScreenChanged(QScreen *screen);
 
@@ -547,6 +558,10 @@ private:
 	std::shared_ptr<Data::DocumentMedia> _documentMedia;
 	base::flat_set<std::shared_ptr<Data::PhotoMedia>> _preloadPhotos;
 	base::flat_set<std::shared_ptr<Data::DocumentMedia>> _preloadDocuments;
+	base::flat_map<not_null<PhotoData*>, PreparedPhoto> _preparedPhotos;
+	crl::time _preloadLastMove = 0;
+	int _preloadDelta = 0;
+	int _preloadStreak = 0;
 	int _rotation = 0;
 	std::unique_ptr<SharedMedia> _sharedMedia;
 	std::optional<SharedMediaWithLastSlice> _sharedMediaData;
@@ -9,9 +9,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "base/random.h"
 
+#include <zlib.h>
+
 namespace MTP::details {
 namespace {
 
+constexpr auto kPackMinSize = 1024;
+constexpr auto kPackFastSize = 256 * 1024;
+
 uint32 CountPaddingPrimesCount(
 		uint32 requestSize,
 		bool forAuthKeyInner) {
@@ -33,6 +38,61 @@ uint32 CountPaddingPrimesCount(
 	return result + ((base::RandomValue<uchar>() & 0x0F) << 2);
 }
 
+// File parts and media are already compressed, file requests are small.
+[[nodiscard]] bool SkipPacking(mtpTypeId type) {
+	switch (type) {
+	case mtpc_gzip_packed:
+	case mtpc_upload_saveFilePart:
+	case mtpc_upload_saveBigFilePart:
+	case mtpc_upload_getFile:
+	case mtpc_upload_getWebFile:
+	case mtpc_upload_getCdnFile:
+	case mtpc_upload_reuploadCdnFile:
+	case mtpc_upload_getCdnFileHashes:
+	case mtpc_upload_getFileHashes:
+	case mtpc_messages_sendMedia:
+	case mtpc_messages_sendMultiMedia:
+		return true;
+	}
+	return false;
+}
+
+[[nodiscard]] QByteArray Compress(const void *data, uint32 size) {
+	// Large payloads are mostly media captions or themes being saved,
+	// prefer lower latency over a slightly better ratio for them.
+	const auto level = (size >= kPackFastSize)
+		? Z_BEST_SPEED
+		: Z_DEFAULT_COMPRESSION;
+
+	z_stream stream;
+	stream.zalloc = nullptr;
+	stream.zfree = nullptr;
+	stream.opaque = nullptr;
+	const auto res = deflateInit2(
+		&stream,
+		level,
+		Z_DEFLATED,
+		16 + MAX_WBITS,
+		8,
+		Z_DEFAULT_STRATEGY);
+	if (res != Z_OK) {
+		LOG(("MTP Error: could not init zlib deflate stream, code: %1"
+			).arg(res));
+		return QByteArray();
+	}
+	auto result = QByteArray(
+		int(deflateBound(&stream, size)),
+		Qt::Uninitialized);
+	stream.avail_in = size;
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<void*>(data));
+	stream.avail_out = result.size();
+	stream.next_out = reinterpret_cast<Bytef*>(result.data());
+	const auto finished = (deflate(&stream, Z_FINISH) == Z_STREAM_END);
+	result.resize(result.size() - stream.avail_out);
+	deflateEnd(&stream);
+	return finished ? result : QByteArray();
+}
+
 } // namespace
 
 SerializedRequest::SerializedRequest(const RequestConstructHider::Tag &tag)
@@ -143,6 +203,69 @@ bool SerializedRequest::needAck() const {
 	return true;
 }
 
+void SerializedRequest::pack() {
+	Expects(_data != nullptr);
+	Expects(_data->size() > kMessageBodyPosition);
+
+	if (_data->packChecked) {
+		return;
+	}
+	_data->packChecked = true;
+	const auto size = uint32(sizeInBytes());
+	const auto type = mtpTypeId((*_data)[kMessageBodyPosition]);
+	if (size < kPackMinSize || SkipPacking(type)) {
+		return;
+	}
+	const auto compressed = Compress(dataInBytes(), size);
+	if (compressed.isEmpty()) {
+		return;
+	}
+	const auto bytes = MTP_bytes(compressed);
+	const auto packedSize = (tl::count_length(bytes) >> 2) + 1;
+	if (packedSize * sizeof(mtpPrime) >= size) {
+		return;
+	}
+	auto &packed = _data->packed;
+	packed.reserve(packedSize);
+	packed.push_back(mtpc_gzip_packed);
+	bytes.write(packed);
+}
+
+SerializedRequest SerializedRequest::forSend() const {
+	Expects(_data != nullptr);
+	Expects(_data->size() > kMessageBodyPosition);
+
+	const auto &packed = _data->packed;
+	if (packed.empty()) {
+		return *this;
+	}
+	auto result = Prepare(packed.size());
+	memcpy(
+		result->data(),
+		_data->constData(),
+		kMessageLengthPosition * sizeof(mtpPrime)); // all except length
+	result->append(packed);
+	result->after = _data->after;
+	result->lastSentTime = _data->lastSentTime;
+	result->requestId = _data->requestId;
+	result->needsLayer = _data->needsLayer;
+	result->forceSendInContainer = _data->forceSendInContainer;
+	result->background = _data->background;
+	return result;
+}
+
+uint32 SerializedRequest::sendMessageSize() const {
+	Expects(_data != nullptr);
+
+	const auto &packed = _data->packed;
+	return packed.empty()
+		? messageSize()
+		: (kMessageIdInts
+			+ kSeqNoInts
+			+ kMessageLengthInts
+			+ uint32(packed.size()));
+}
+
 size_t SerializedRequest::sizeInBytes() const {
 	Expects(!_data || _data->size() > kMessageBodyPosition);
 	return _data ? (*_data)[kMessageLengthPosition] : 0;
@@ -70,6 +70,15 @@ public:
 
 	[[nodiscard]] bool needAck() const;
 
+	// Compresses the body to a separate gzip_packed buffer, only once.
+	// The request itself stays unchanged for resending and invokeAfter.
+	void pack();
+
+	// The request as it is written to the connection, with the packed
+	// body if it was compressed, and its size in the same units.
+	[[nodiscard]] SerializedRequest forSend() const;
+	[[nodiscard]] uint32 sendMessageSize() const;
+
 	using ResponseType = void; // don't know real response type =(
 
 private:
@@ -89,9 +98,13 @@ public:
 
 	SerializedRequest after;
 	crl::time lastSentTime = 0;
+	crl::time queuedTime = 0;
 	mtpRequestId requestId = 0;
 	bool needsLayer = false;
 	bool forceSendInContainer = false;
+	bool background = false;
+	bool packChecked = false;
+	mtpBuffer packed;
 
 };
 
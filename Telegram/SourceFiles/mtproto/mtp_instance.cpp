@@ -38,6 +38,30 @@ using namespace details;
 
 std::atomic<int> GlobalAtomicRequestId = 0;
 
+// Requests that refresh or mark data in bulk and are never waited for
+// by the user directly, they yield to everything else in the session.
+[[nodiscard]] bool IsBackgroundRequest(const SerializedRequest &request) {
+	switch ((*request)[SerializedRequest::kMessageBodyPosition]) {
+	case mtpc_messages_getStickerSet:
+	case mtpc_messages_getCustomEmojiDocuments:
+	case mtpc_messages_getMessagesViews:
+	case mtpc_users_getFullUser:
+	case mtpc_messages_getFullChat:
+	case mtpc_channels_getFullChannel:
+	case mtpc_messages_readHistory:
+	case mtpc_channels_readHistory:
+	case mtpc_messages_readMentions:
+	case mtpc_messages_readReactions:
+	case mtpc_messages_readMessageContents:
+	case mtpc_channels_readMessageContents:
+	case mtpc_messages_readFeaturedStickers:
+	case mtpc_stories_readStories:
+	case mtpc_stories_incrementStoryViews:
+		return true;
+	}
+	return false;
+}
+
 } // namespace
 
 namespace details {
@@ -1004,6 +1028,7 @@ void Instance::Private::sendRequest(
 	const auto session = getSession(shiftedDcId);
 
 	request->requestId = requestId;
+	request->background = IsBackgroundRequest(request);
 	storeRequest(requestId, request, std::move(callbacks));
 
 	const auto toMainDc = (shiftedDcId == 0);
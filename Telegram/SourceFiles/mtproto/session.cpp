@@ -36,6 +36,13 @@ SessionOptions::SessionOptions(
 , useTcp(useTcp) {
 }
 
+SessionData::~SessionData() {
+	auto node = _received.exchange(nullptr);
+	while (node) {
+		delete std::exchange(node, node->next);
+	}
+}
+
 template <typename Callback>
 void SessionData::withSession(Callback &&callback) {
 	QMutexLocker lock(&_ownerMutex);
@@ -63,6 +70,59 @@ void SessionData::notifyConnectionInited(const SessionOptions &options) {
 	}
 }
 
+void SessionData::pushReceived(Response &&response) {
+	const auto node = new ReceivedNode{ std::move(response) };
+	node->next = _received.load(std::memory_order_relaxed);
+	while (!_received.compare_exchange_weak(
+			node->next,
+			node,
+			std::memory_order_release,
+			std::memory_order_relaxed)) {
+	}
+}
+
+void SessionData::lockToSendCounted() {
+	if (!_toSendLock.tryLockForWrite()) {
+		_toSendContention.fetch_add(1, std::memory_order_relaxed);
+		_toSendLock.lockForWrite();
+	}
+}
+
+int SessionData::takeToSendContention() {
+	return _toSendContention.exchange(0, std::memory_order_relaxed);
+}
+
+bool SessionData::hasReceived() const {
+	return _received.load(std::memory_order_acquire) != nullptr;
+}
+
+std::vector<Response> SessionData::takeReceived() {
+	auto node = _received.exchange(nullptr, std::memory_order_acquire);
+	auto result = std::vector<Response>();
+	while (node) {
+		result.push_back(std::move(node->response));
+		delete std::exchange(node, node->next);
+	}
+
+	// Nodes were pushed to the top of the stack, restore arrival order.
+	ranges::reverse(result);
+	return result;
+}
+
+void SessionData::cancelSentLater(mtpMsgId msgId) {
+	QMutexLocker lock(&_cancelledSentMutex);
+	_cancelledSent.emplace(msgId);
+	_hasCancelledSent = true;
+}
+
+base::flat_set<mtpMsgId> SessionData::takeCancelledSent() {
+	if (!_hasCancelledSent.exchange(false)) {
+		return {};
+	}
+	QMutexLocker lock(&_cancelledSentMutex);
+	return base::take(_cancelledSent);
+}
+
 void SessionData::queueTryToReceive() {
 	withSession([](not_null<Session*> session) {
 		session->tryToReceive();
@@ -354,8 +414,16 @@ void Session::cancel(mtpRequestId requestId, mtpMsgId msgId) {
 		_data->toSendMap().remove(requestId);
 	}
 	if (msgId) {
-		QWriteLocker locker(_data->haveSentMutex());
-		_data->haveSentMap().remove(msgId);
+		// Sent requests are owned by the connection thread. Without
+		// a connection the stopped one may still be finishing there,
+		// so the next one removes the request before sending anything.
+		if (const auto captured = _private) {
+			InvokeQueued(captured, [=] {
+				captured->cancelSent(msgId);
+			});
+		} else {
+			_data->cancelSentLater(msgId);
+		}
 	}
 }
 
@@ -427,7 +495,11 @@ void Session::sendPrepared(
 	DEBUG_LOG(("MTP Info: adding request to toSendMap, msCanWait %1"
 		).arg(msCanWait));
 	{
-		QWriteLocker locker(_data->toSendMutex());
+		_data->lockToSendCounted();
+		const auto unlock = gsl::finally([&] {
+			_data->toSendMutex()->unlock();
+		});
+		request->queuedTime = Logs::DebugEnabled() ? crl::now() : 0;
 		_data->toSendMap().emplace(request->requestId, request);
 		*(mtpMsgId*)(request->data() + 4) = 0;
 		*(request->data() + 6) = 0;
@@ -550,10 +622,14 @@ void Session::tryToReceive() {
 		_needToReceive = true;
 		return;
 	}
+	if (const auto contention = _data->takeToSendContention()) {
+		DEBUG_LOG(("Session Info: "
+			"%1 contended locks of the send queue, dcWithShift %2"
+			).arg(contention
+			).arg(_shiftedDcId));
+	}
 	while (true) {
-		auto lock = QWriteLocker(_data->haveReceivedMutex());
-		const auto messages = base::take(_data->haveReceivedMessages());
-		lock.unlock();
+		const auto messages = _data->takeReceived();
 		if (messages.empty()) {
 			break;
 		}
@@ -14,6 +14,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtCore/QTimer>
 
+#include <atomic>
+
 namespace MTP {
 
 class Instance;
@@ -57,6 +59,7 @@ class SessionData final {
 public:
 	explicit SessionData(not_null<Session*> creator) : _owner(creator) {
 	}
+	~SessionData();
 
 	void notifyConnectionInited(const SessionOptions &options);
 	void setOptions(SessionOptions options) {
@@ -71,22 +74,27 @@ public:
 	not_null<QReadWriteLock*> toSendMutex() {
 		return &_toSendLock;
 	}
-	not_null<QReadWriteLock*> haveSentMutex() {
-		return &_haveSentLock;
-	}
-	not_null<QReadWriteLock*> haveReceivedMutex() {
-		return &_haveReceivedLock;
-	}
+	// Locks for write, counting the times the lock was already taken.
+	void lockToSendCounted();
+	[[nodiscard]] int takeToSendContention();
 
 	base::flat_map<mtpRequestId, SerializedRequest> &toSendMap() {
 		return _toSend;
 	}
+
+	// Accessed only from the connection thread, no locking required.
 	base::flat_map<mtpMsgId, SerializedRequest> &haveSentMap() {
 		return _haveSent;
 	}
-	std::vector<Response> &haveReceivedMessages() {
-		return _receivedMessages;
-	}
+
+	// Session -> SessionPrivate, cancels made while there is no connection.
+	void cancelSentLater(mtpMsgId msgId);
+	[[nodiscard]] base::flat_set<mtpMsgId> takeCancelledSent();
+
+	// SessionPrivate -> Session responses queue, lock-free.
+	void pushReceived(Response &&response);
+	[[nodiscard]] bool hasReceived() const;
+	[[nodiscard]] std::vector<Response> takeReceived();
 
 	// SessionPrivate -> Session interface.
 	void queueTryToReceive();
@@ -110,6 +118,11 @@ public:
 	void detach();
 
 private:
+	struct ReceivedNode {
+		Response response;
+		ReceivedNode *next = nullptr;
+	};
+
 	template <typename Callback>
 	void withSession(Callback &&callback);
 
@@ -121,12 +134,15 @@ private:
 
 	base::flat_map<mtpRequestId, SerializedRequest> _toSend; // map of request_id -> request, that is waiting to be sent
 	QReadWriteLock _toSendLock;
+	std::atomic<int> _toSendContention = 0;
 
 	base::flat_map<mtpMsgId, SerializedRequest> _haveSent; // map of msg_id -> request, that was sent
-	QReadWriteLock _haveSentLock;
 
-	std::vector<Response> _receivedMessages; // list of responses / updates that should be processed in the main thread
-	QReadWriteLock _haveReceivedLock;
+	base::flat_set<mtpMsgId> _cancelledSent;
+	std::atomic<bool> _hasCancelledSent = false;
+	QMutex _cancelledSentMutex;
+
+	std::atomic<ReceivedNode*> _received = nullptr; // stack of responses / updates that should be processed in the main thread
 
 };
 
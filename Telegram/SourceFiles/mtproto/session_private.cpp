@@ -50,6 +50,9 @@ constexpr auto kRequestConfigTimeout = 8 * crl::time(1000);
 // Don't try to handle messages larger than this size.
 constexpr auto kMaxMessageLength = 16 * 1024 * 1024;
 
+// Don't keep huge unpacked containers around between messages.
+constexpr auto kMaxReusedUngzipBuffer = 1024 * 1024 / kIntSize;
+
 // How much time passed from send till we resend request or check its state.
 constexpr auto kCheckSentRequestTimeout = 10 * crl::time(1000);
 
@@ -60,6 +63,12 @@ constexpr auto kSendStateRequestWaiting = crl::time(1000);
 // How much time to wait for some more requests, when sending msg acks.
 constexpr auto kAckSendWaiting = 10 * crl::time(1000);
 
+// How often to write queueing delays to the debug log.
+constexpr auto kQueueDelaysReportPeriod = 60 * crl::time(1000);
+
+// How many background requests can wait for a response at the same time.
+constexpr auto kBackgroundRequestsInFlight = 8;
+
 auto SyncTimeRequestDuration = kFastRequestDuration;
 
 using namespace details;
@@ -262,7 +271,6 @@ void SessionPrivate::checkSentRequests() {
 	auto requesting = false;
 	auto nextTimeout = kCheckSentRequestTimeout;
 	{
-		QReadLocker locker(_sessionData->haveSentMutex());
 		auto &haveSent = _sessionData->haveSentMap();
 		for (const auto &[msgId, request] : haveSent) {
 			if (request->lastSentTime <= checkTime) {
@@ -472,7 +480,6 @@ mtpMsgId SessionPrivate::replaceMsgId(SerializedRequest &request, mtpMsgId newId
 	if (oldMsgId == newId) {
 		return newId;
 	}
-	// haveSentMutex() was locked in tryToSend()
 	auto &haveSent = _sessionData->haveSentMap();
 
 	while (_resendingIds.contains(newId)
@@ -568,6 +575,8 @@ void SessionPrivate::tryToSend() {
 		return;
 	}
 
+	removeCancelledSent();
+
 	const auto needsLayer = !_sessionData->connectionInited();
 	const auto state = getState();
 	const auto sendOnlyFirstPing = (state != ConnectedState);
@@ -696,6 +705,10 @@ void SessionPrivate::tryToSend() {
 		initSize = initSizeInInts * sizeof(mtpPrime);
 	}
 
+	if (sendAll) {
+		packQueuedRequests();
+	}
+
 	bool needAnyResponse = false;
 	SerializedRequest toSendRequest;
 	{
@@ -710,6 +723,8 @@ void SessionPrivate::tryToSend() {
 		if (!sendAll) {
 			locker1.unlock();
 		}
+		auto deferred = deferBackground(toSend);
+		registerQueueDelays(toSend);
 
 		uint32 toSendCount = toSend.size();
 		if (pingRequest) ++toSendCount;
@@ -720,6 +735,7 @@ void SessionPrivate::tryToSend() {
 		if (bindDcKeyRequest) ++toSendCount;
 
 		if (!toSendCount) {
+			toSend = std::move(deferred);
 			return; // nothing to send
 		}
 
@@ -739,7 +755,7 @@ void SessionPrivate::tryToSend() {
 		if (toSendCount == 1 && !first->forceSendInContainer) {
 			toSendRequest = first;
 			if (sendAll) {
-				toSend.clear();
+				toSend = std::move(deferred);
 				locker1.unlock();
 			}
 
@@ -765,10 +781,10 @@ void SessionPrivate::tryToSend() {
 				if (toSendRequest.needAck()) {
 					toSendRequest->lastSentTime = crl::now();
 
-					QWriteLocker locker2(_sessionData->haveSentMutex());
 					auto &haveSent = _sessionData->haveSentMap();
 					haveSent.emplace(msgId, toSendRequest);
 					scheduleCheckSentRequests = true;
+					toSendRequest = toSendRequest.forSend();
 
 					const auto wrapLayer = needsLayer && toSendRequest->needsLayer;
 					if (toSendRequest->after) {
@@ -809,7 +825,7 @@ void SessionPrivate::tryToSend() {
 			if (httpWaitRequest) containerSize += httpWaitRequest.messageSize();
 			if (bindDcKeyRequest) containerSize += bindDcKeyRequest.messageSize();
 			for (const auto &[requestId, request] : toSend) {
-				containerSize += request.messageSize();
+				containerSize += request.sendMessageSize();
 				if (needsLayer && request->needsLayer) {
 					containerSize += initSizeInInts;
 					willNeedInit = true;
@@ -832,8 +848,6 @@ void SessionPrivate::tryToSend() {
 			// check for a valid container
 			auto bigMsgId = base::unixtime::mtproto_msg_id();
 
-			// the fact of this lock is used in replaceMsgId()
-			QWriteLocker locker2(_sessionData->haveSentMutex());
 			auto &haveSent = _sessionData->haveSentMap();
 
 			// prepare sent container
@@ -867,23 +881,24 @@ void SessionPrivate::tryToSend() {
 				if (msgId >= bigMsgId) {
 					bigMsgId = base::unixtime::mtproto_msg_id();
 				}
+				const auto body = request.forSend();
 				bool added = false;
 				if (request->requestId) {
 					if (request.needAck()) {
 						request->lastSentTime = crl::now();
 						int32 reqNeedsLayer = (needsLayer && request->needsLayer) ? toSendRequest->size() : 0;
 						if (request->after) {
-							WrapInvokeAfter(toSendRequest, request, haveSent, reqNeedsLayer ? initSizeInInts : 0);
+							WrapInvokeAfter(toSendRequest, body, haveSent, reqNeedsLayer ? initSizeInInts : 0);
 							if (reqNeedsLayer) {
 								memcpy(toSendRequest->data() + reqNeedsLayer + 4, initSerialized.constData(), initSize);
 								*(toSendRequest->data() + reqNeedsLayer + 3) += initSize;
 							}
 							added = true;
 						} else if (reqNeedsLayer) {
-							toSendRequest->resize(reqNeedsLayer + initSizeInInts + request.messageSize());
-							memcpy(toSendRequest->data() + reqNeedsLayer, request->constData() + 4, 4 * sizeof(mtpPrime));
+							toSendRequest->resize(reqNeedsLayer + initSizeInInts + body.messageSize());
+							memcpy(toSendRequest->data() + reqNeedsLayer, body->constData() + 4, 4 * sizeof(mtpPrime));
 							memcpy(toSendRequest->data() + reqNeedsLayer + 4, initSerialized.constData(), initSize);
-							memcpy(toSendRequest->data() + reqNeedsLayer + 4 + initSizeInInts, request->constData() + 8, tl::count_length(request));
+							memcpy(toSendRequest->data() + reqNeedsLayer + 4 + initSizeInInts, body->constData() + 8, tl::count_length(body));
 							*(toSendRequest->data() + reqNeedsLayer + 3) += initSize;
 							added = true;
 						}
@@ -899,12 +914,12 @@ void SessionPrivate::tryToSend() {
 					}
 				}
 				if (!added) {
-					uint32 from = toSendRequest->size(), len = request.messageSize();
+					uint32 from = toSendRequest->size(), len = body.messageSize();
 					toSendRequest->resize(from + len);
-					memcpy(toSendRequest->data() + from, request->constData() + 4, len * sizeof(mtpPrime));
+					memcpy(toSendRequest->data() + from, body->constData() + 4, len * sizeof(mtpPrime));
 				}
 			}
-			toSend.clear();
+			toSend = std::move(deferred);
 
 			if (stateRequest) {
 				const auto msgId = placeToContainer(
@@ -953,6 +968,112 @@ void SessionPrivate::tryToSend() {
 	sendSecureRequest(std::move(toSendRequest), needAnyResponse);
 }
 
+auto SessionPrivate::deferBackground(
+		base::flat_map<mtpRequestId, SerializedRequest> &toSend)
+-> base::flat_map<mtpRequestId, SerializedRequest> {
+	auto result = base::flat_map<mtpRequestId, SerializedRequest>();
+	const auto background = [](const auto &pair) {
+		return pair.second->background;
+	};
+	if (ranges::none_of(toSend, background)) {
+		return result;
+	}
+	auto inFlight = int(ranges::count_if(
+		_sessionData->haveSentMap(),
+		background));
+	for (auto i = begin(toSend); i != end(toSend);) {
+		const auto &request = i->second;
+		const auto after = request->after
+			? request->after->requestId
+			: mtpRequestId(0);
+
+		// Keep invokeAfter chains in order, even for interactive requests.
+		const auto defer = (after && result.contains(after))
+			|| (request->background
+				&& inFlight++ >= kBackgroundRequestsInFlight);
+		if (defer) {
+			result.emplace(i->first, request);
+			i = toSend.erase(i);
+		} else {
+			++i;
+		}
+	}
+	_backgroundDeferred = !result.empty();
+	if (_backgroundDeferred) {
+		DEBUG_LOG(("MTP Info: deferred %1 background requests"
+			).arg(result.size()));
+	}
+	return result;
+}
+
+void SessionPrivate::packQueuedRequests() {
+	auto list = std::vector<SerializedRequest>();
+	{
+		QReadLocker locker(_sessionData->toSendMutex());
+		for (const auto &[requestId, request] : _sessionData->toSendMap()) {
+			if (request->needsLayer && !request->packChecked) {
+				list.push_back(request);
+			}
+		}
+	}
+
+	// Compress outside of the lock so that sendPrepared() calls
+	// from the main thread don't wait for the deflate to finish.
+	// Each request is tried only once, even if it didn't shrink.
+	for (auto &request : list) {
+		request.pack();
+	}
+}
+
+void SessionPrivate::registerQueueDelays(
+		const base::flat_map<mtpRequestId, SerializedRequest> &toSend) {
+	const auto now = crl::now();
+	reportQueueDelays(now);
+	for (const auto &[requestId, request] : toSend) {
+		if (!request->queuedTime) {
+			continue;
+		}
+		const auto delay = now - base::take(request->queuedTime);
+		if (!_queueDelays.started) {
+			continue;
+		}
+		auto &stats = request->background
+			? _queueDelays.background
+			: _queueDelays.interactive;
+		stats.total += delay;
+		stats.max = std::max(stats.max, delay);
+		++stats.count;
+	}
+}
+
+void SessionPrivate::reportQueueDelays(crl::time now) {
+	// Nothing is collected while the debug log is disabled.
+	if (!Logs::DebugEnabled()) {
+		if (_queueDelays.started) {
+			_queueDelays = QueueDelays();
+		}
+		return;
+	} else if (!_queueDelays.started) {
+		_queueDelays.started = now;
+		return;
+	} else if (now - _queueDelays.started < kQueueDelaysReportPeriod) {
+		return;
+	}
+	const auto delays = std::exchange(
+		_queueDelays,
+		QueueDelays{ .started = now });
+	const auto average = [](const QueueDelay &delay) {
+		return delay.count ? (delay.total / delay.count) : crl::time(0);
+	};
+	DEBUG_LOG(("MTP Info: queueing delay for dcWithShift %1, "
+		"interactive avg: %2, max: %3, background avg: %4, max: %5"
+		).arg(_shiftedDcId
+		).arg(average(delays.interactive)
+		).arg(delays.interactive.max
+		).arg(average(delays.background)
+		).arg(delays.background.max));
+}
+
 void SessionPrivate::retryByTimer() {
 	if (_retryTimeout < 3) {
 		++_retryTimeout;
@@ -1379,12 +1500,8 @@ void SessionPrivate::handleReceived() {
 			_sessionData->queueSendAnything(kAckSendWaiting);
 		}
 
-		auto lock = QReadLocker(_sessionData->haveReceivedMutex());
-		const auto tryToReceive = !_sessionData->haveReceivedMessages().empty();
-		lock.unlock();
-
-		if (tryToReceive) {
-			DEBUG_LOG(("MTP Info: queueTryToReceive() - need to parse in another thread, %1 messages.").arg(_sessionData->haveReceivedMessages().size()));
+		if (_sessionData->hasReceived()) {
+			DEBUG_LOG(("MTP Info: queueTryToReceive() - need to parse in another thread."));
 			_sessionData->queueTryToReceive();
 		}
 
@@ -1422,11 +1539,21 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 
 	case mtpc_gzip_packed: {
 		DEBUG_LOG(("Message Info: gzip container"));
-		mtpBuffer response = ungzip(++from, end);
-		if (response.empty()) {
+
+		// Nested gzip_packed will just use a fresh buffer.
+		auto response = base::take(_ungzipBuffer);
+		if (!ungzip(++from, end, response)) {
 			return HandleResult::RestartConnection;
 		}
-		return handleOneReceived(response.data(), response.data() + response.size(), msgId, info);
+		const auto result = handleOneReceived(
+			response.constData(),
+			response.constData() + response.size(),
+			msgId,
+			info);
+		if (response.capacity() <= kMaxReusedUngzipBuffer) {
+			_ungzipBuffer = std::move(response);
+		}
+		return result;
 	}
 
 	case mtpc_msg_container: {
@@ -1597,8 +1724,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 				)).write(reply);
 
 				// Save rpc_error for processing in the main thread.
-				QWriteLocker locker(_sessionData->haveReceivedMutex());
-				_sessionData->haveReceivedMessages().push_back({
+				_sessionData->pushReceived({
 					.reply = std::move(reply),
 					.outerMsgId = info.outerMsgId,
 					.requestId = requestId,
@@ -1797,14 +1923,13 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		mtpTypeId typeId = from[0];
 		if (typeId == mtpc_gzip_packed) {
 			DEBUG_LOG(("RPC Info: gzip container"));
-			response = ungzip(++from, end);
-			if (response.empty()) {
+			if (!ungzip(++from, end, response)) {
 				return HandleResult::RestartConnection;
 			}
 			typeId = response[0];
 		} else {
-			response.resize(end - from);
-			memcpy(response.data(), from, (end - from) * sizeof(mtpPrime));
+			// Copy the payload once, without zero-filling it first.
+			response = mtpBuffer(from, end);
 		}
 		if (typeId == mtpc_rpc_error) {
 			if (IsDestroyedTemporaryKeyError(response)) {
@@ -1825,8 +1950,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		const auto requestId = wasSent(requestMsgId);
 		if (requestId && requestId != mtpRequestId(0xFFFFFFFF)) {
 			// Save rpc_result for processing in the main thread.
-			QWriteLocker locker(_sessionData->haveReceivedMutex());
-			_sessionData->haveReceivedMessages().push_back({
+			_sessionData->pushReceived({
 				.reply = std::move(response),
 				.outerMsgId = info.outerMsgId,
 				.requestId = requestId,
@@ -1859,7 +1983,6 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		mtpMsgId firstMsgId = data.vfirst_msg_id().v;
 		QVector<quint64> toResend;
 		{
-			QReadLocker locker(_sessionData->haveSentMutex());
 			const auto &haveSent = _sessionData->haveSentMap();
 			toResend.reserve(haveSent.size());
 			for (const auto &[msgId, request] : haveSent) {
@@ -1878,8 +2001,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		if (from > start) memcpy(update.data(), start, (from - start) * sizeof(mtpPrime));
 
 		// Notify main process about new session - need to get difference.
-		QWriteLocker locker(_sessionData->haveReceivedMutex());
-		_sessionData->haveReceivedMessages().push_back({
+		_sessionData->pushReceived({
 			.reply = update,
 			.outerMsgId = info.outerMsgId,
 		});
@@ -1928,8 +2050,7 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		}
 
 		// Notify main process about the new updates.
-		QWriteLocker locker(_sessionData->haveReceivedMutex());
-		_sessionData->haveReceivedMessages().push_back({
+		_sessionData->pushReceived({
 			.reply = update,
 			.outerMsgId = info.outerMsgId,
 		});
@@ -1971,16 +2092,41 @@ SessionPrivate::HandleResult SessionPrivate::handleBindResponse(
 	Unexpected("Result of BoundKeyCreator::handleBindResponse.");
 }
 
-mtpBuffer SessionPrivate::ungzip(const mtpPrime *from, const mtpPrime *end) const {
-	mtpBuffer result; // * 4 because of mtpPrime type
-	result.resize(0);
+bool SessionPrivate::ungzip(
+		const mtpPrime *from,
+		const mtpPrime *end,
+		mtpBuffer &to) const {
+	to.resize(0);
 
-	MTPstring packed;
-	if (!packed.read(from, end)) { // read packed string as serialized mtp string type
+	// Read packed bytes in place instead of copying them to MTPbytes.
+	if (from >= end) {
 		LOG(("RPC Error: could not read gziped bytes."));
-		return result;
+		return false;
+	}
+	const auto header = reinterpret_cast<const uchar*>(from);
+	const auto longLength = (header[0] == 254);
+	const auto packedLen = longLength
+		? (uint32(header[1])
+			| (uint32(header[2]) << 8)
+			| (uint32(header[3]) << 16))
+		: uint32(header[0]);
+	const auto packedStart = header + (longLength ? 4 : 1);
+	if (header[0] == 255
+		|| packedStart + packedLen > reinterpret_cast<const uchar*>(end)) {
+		LOG(("RPC Error: could not read gziped bytes."));
+		return false;
 	}
-	uint32 packedLen = packed.v.size(), unpackedChunk = packedLen;
+
+	// Last four bytes of gzip data hold the unpacked size modulo 2^32,
+	// use it as a hint to inflate without reallocations.
+	auto hint = uint32(0);
+	if (packedLen >= 4) {
+		memcpy(&hint, packedStart + packedLen - 4, 4);
+	}
+	const auto hinted = (hint > 0 && hint <= kMaxMessageLength)
+		? int((hint + kIntSize - 1) / kIntSize)
+		: 0;
+	auto unpackedChunk = std::max(hinted, int(packedLen / kIntSize) + 1);
 
 	z_stream stream;
 	stream.zalloc = 0;
@@ -1991,36 +2137,48 @@ mtpBuffer SessionPrivate::ungzip(const mtpPrime *from, const mtpPrime *end) cons
 	int res = inflateInit2(&stream, 16 + MAX_WBITS);
 	if (res != Z_OK) {
 		LOG(("RPC Error: could not init zlib stream, code: %1").arg(res));
-		return result;
+		return false;
 	}
 	stream.avail_in = packedLen;
-	stream.next_in = reinterpret_cast<Bytef*>(packed.v.data());
+	stream.next_in = const_cast<Bytef*>(packedStart);
 
+	to.reserve(unpackedChunk);
 	stream.avail_out = 0;
-	while (!stream.avail_out) {
-		result.resize(result.size() + unpackedChunk);
-		stream.avail_out = unpackedChunk * sizeof(mtpPrime);
-		stream.next_out = (Bytef*)&result[result.size() - unpackedChunk];
-		int res = inflate(&stream, Z_NO_FLUSH);
+	res = Z_OK;
+	while (res != Z_STREAM_END) {
+		if (!stream.avail_out) {
+			const auto was = to.size();
+			to.resize(was + unpackedChunk);
+			stream.avail_out = unpackedChunk * sizeof(mtpPrime);
+			stream.next_out = reinterpret_cast<Bytef*>(to.data() + was);
+
+			// The hint was wrong, grow geometrically from now on.
+			unpackedChunk = to.size();
+		}
+		res = inflate(&stream, Z_NO_FLUSH);
 		if (res != Z_OK && res != Z_STREAM_END) {
 			inflateEnd(&stream);
 			LOG(("RPC Error: could not unpack gziped data, code: %1").arg(res));
-			DEBUG_LOG(("RPC Error: bad gzip: %1").arg(Logs::mb(packed.v.constData(), packedLen).str()));
-			return mtpBuffer();
+			DEBUG_LOG(("RPC Error: bad gzip: %1").arg(Logs::mb(packedStart, packedLen).str()));
+			to.resize(0);
+			return false;
 		}
 	}
 	if (stream.avail_out & 0x03) {
-		uint32 badSize = result.size() * sizeof(mtpPrime) - stream.avail_out;
+		uint32 badSize = to.size() * sizeof(mtpPrime) - stream.avail_out;
 		LOG(("RPC Error: bad length of unpacked data %1").arg(badSize));
-		DEBUG_LOG(("RPC Error: bad unpacked data %1").arg(Logs::mb(result.data(), badSize).str()));
-		return mtpBuffer();
+		DEBUG_LOG(("RPC Error: bad unpacked data %1").arg(Logs::mb(to.data(), badSize).str()));
+		inflateEnd(&stream);
+		to.resize(0);
+		return false;
 	}
-	result.resize(result.size() - (stream.avail_out >> 2));
+	to.resize(to.size() - (stream.avail_out >> 2));
 	inflateEnd(&stream);
-	if (!result.size()) {
+	if (!to.size()) {
 		LOG(("RPC Error: bad length of unpacked data 0"));
+		return false;
 	}
-	return result;
+	return true;
 }
 
 bool SessionPrivate::requestsFixTimeSalt(const QVector<MTPlong> &ids, const OuterInfo &info) {
@@ -2042,7 +2200,6 @@ void SessionPrivate::correctUnixtimeByFastRequest(
 		TimeId serverTime) {
 	const auto now = crl::now();
 
-	QReadLocker locker(_sessionData->haveSentMutex());
 	const auto &haveSent = _sessionData->haveSentMap();
 	for (const auto &id : ids) {
 		const auto i = haveSent.find(id.v);
@@ -2071,7 +2228,6 @@ void SessionPrivate::requestsAcked(const QVector<MTPlong> &ids, bool byResponse)
 
 	QVector<MTPlong> toAckMore;
 	{
-		QWriteLocker locker2(_sessionData->haveSentMutex());
 		auto &haveSent = _sessionData->haveSentMap();
 
 		for (const auto &wrappedMsgId : ids) {
@@ -2097,7 +2253,9 @@ void SessionPrivate::requestsAcked(const QVector<MTPlong> &ids, bool byResponse)
 					DEBUG_LOG(("Message Info: ignoring ACK for msgId %1 because request %2 requires a response").arg(msgId).arg(requestId));
 					continue;
 				}
+				const auto request = i->second;
 				haveSent.erase(i);
+				sentRequestRemoved(request);
 
 				_ackedIds.emplace(msgId, requestId);
 				continue;
@@ -2164,7 +2322,6 @@ void SessionPrivate::handleMsgsStates(const QVector<MTPlong> &ids, const QByteAr
 		const auto state = states[i];
 		const auto requestMsgId = ids[i].v;
 		{
-			QReadLocker locker(_sessionData->haveSentMutex());
 			if (!_sessionData->haveSentMap().contains(requestMsgId)) {
 				DEBUG_LOG(("Message Info: state was received for msgId %1, but request is not found, looking in resent requests...").arg(requestMsgId));
 				const auto reqIt = _resendingIds.find(requestMsgId);
@@ -2219,7 +2376,6 @@ void SessionPrivate::resend(mtpMsgId msgId, crl::time msCanWait) {
 		}
 		return;
 	}
-	auto lock = QWriteLocker(_sessionData->haveSentMutex());
 	auto &haveSent = _sessionData->haveSentMap();
 	auto i = haveSent.find(msgId);
 	if (i == haveSent.end()) {
@@ -2227,7 +2383,7 @@ void SessionPrivate::resend(mtpMsgId msgId, crl::time msCanWait) {
 	}
 	auto request = i->second;
 	haveSent.erase(i);
-	lock.unlock();
+	sentRequestRemoved(request);
 
 	request->lastSentTime = crl::now();
 	request->forceSendInContainer = true;
@@ -2238,10 +2394,35 @@ void SessionPrivate::resend(mtpMsgId msgId, crl::time msCanWait) {
 	}
 }
 
+void SessionPrivate::cancelSent(mtpMsgId msgId) {
+	auto &haveSent = _sessionData->haveSentMap();
+	const auto i = haveSent.find(msgId);
+	if (i == end(haveSent)) {
+		return;
+	}
+	const auto request = i->second;
+	haveSent.erase(i);
+	sentRequestRemoved(request);
+}
+
+void SessionPrivate::removeCancelledSent() {
+	for (const auto msgId : _sessionData->takeCancelledSent()) {
+		cancelSent(msgId);
+	}
+}
+
+void SessionPrivate::sentRequestRemoved(const SerializedRequest &request) {
+	// A background request left the in-flight set,
+	// the deferred ones may take its place now.
+	if (request->background && _backgroundDeferred) {
+		_backgroundDeferred = false;
+		_sessionData->queueSendAnything();
+	}
+}
+
 void SessionPrivate::resendAll() {
-	auto lock = QWriteLocker(_sessionData->haveSentMutex());
+	removeCancelledSent();
 	auto haveSent = base::take(_sessionData->haveSentMap());
-	lock.unlock();
 	{
 		auto lock = QWriteLocker(_sessionData->toSendMutex());
 		auto &toSend = _sessionData->toSendMap();
@@ -2669,7 +2850,6 @@ mtpRequestId SessionPrivate::wasSent(mtpMsgId msgId) const {
 	}
 
 	{
-		QReadLocker locker(_sessionData->haveSentMutex());
 		const auto &haveSent = _sessionData->haveSentMap();
 		const auto i = haveSent.find(msgId);
 		if (i != haveSent.end()) {
@@ -49,6 +49,7 @@ public:
 	void restartNow();
 	void sendPingForce();
 	void tryToSend();
+	void cancelSent(mtpMsgId msgId);
 
 private:
 	static constexpr auto kUpdateStateAlways = 666;
@@ -61,6 +62,16 @@ private:
 		crl::time sent = 0;
 		std::vector<mtpMsgId> messages;
 	};
+	struct QueueDelay {
+		crl::time total = 0;
+		crl::time max = 0;
+		int count = 0;
+	};
+	struct QueueDelays {
+		crl::time started = 0;
+		QueueDelay interactive;
+		QueueDelay background;
+	};
 	enum class HandleResult {
 		Success,
 		Ignored,
@@ -133,7 +144,10 @@ private:
 	[[nodiscard]] HandleResult handleBindResponse(
 		mtpMsgId requestMsgId,
 		const mtpBuffer &response);
-	mtpBuffer ungzip(const mtpPrime *from, const mtpPrime *end) const;
+	[[nodiscard]] bool ungzip(
+		const mtpPrime *from,
+		const mtpPrime *end,
+		mtpBuffer &to) const;
 	void handleMsgsStates(const QVector<MTPlong> &ids, const QByteArray &states);
 
 	// _sessionDataMutex must be locked for read.
@@ -157,8 +171,20 @@ private:
 	// remove msgs with such ids from sessionData->haveSent, add to sessionData->wereAcked
 	void requestsAcked(const QVector<MTPlong> &ids, bool byResponse = false);
 
+	// Takes out background requests over the in-flight limit,
+	// they are put back to the to-send map after sending the rest.
+	[[nodiscard]] auto deferBackground(
+		base::flat_map<mtpRequestId, SerializedRequest> &toSend)
+	-> base::flat_map<mtpRequestId, SerializedRequest>;
+	void registerQueueDelays(
+		const base::flat_map<mtpRequestId, SerializedRequest> &toSend);
+	void reportQueueDelays(crl::time now);
+	void packQueuedRequests();
+
 	void resend(mtpMsgId msgId, crl::time msCanWait = 0);
 	void resendAll();
+	void sentRequestRemoved(const SerializedRequest &request);
+	void removeCancelledSent();
 	void clearSpecialMsgId(mtpMsgId msgId);
 
 	[[nodiscard]] DcType tryAcquireKeyCreation();
@@ -233,6 +259,9 @@ private:
 	base::flat_map<mtpMsgId, mtpRequestId> _ackedIds;
 	base::flat_map<mtpMsgId, SerializedRequest> _stateAndResendRequests;
 	base::flat_map<mtpMsgId, SentContainer> _sentContainers;
+	QueueDelays _queueDelays;
+	bool _backgroundDeferred = false;
+	mtpBuffer _ungzipBuffer;
 
 	std::unique_ptr<BoundKeyCreator> _keyCreator;
 	mtpMsgId _bindMsgId = 0;
@@ -541,9 +541,11 @@ void Uploader::sendNext() {
 		QByteArray toSend;
 		if (content.isEmpty()) {
 			if (!uploadingData.docFile) {
-				const auto filepath = uploadingData.file
-					? uploadingData.file->filepath
-					: uploadingData.media.file;
+				const auto filepath = !uploadingData.file
+					? uploadingData.media.file
+					: !uploadingData.file->uploadpath.isEmpty()
+					? uploadingData.file->uploadpath
+					: uploadingData.file->filepath;
 				uploadingData.docFile = std::make_unique<QFile>(filepath);
 				if (!uploadingData.docFile->open(QIODevice::ReadOnly)) {
 					currentFailed();
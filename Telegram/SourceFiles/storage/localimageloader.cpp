@@ -20,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "editor/scene/scene_item_sticker.h"
 #include "editor/scene/scene.h"
 #include "media/audio/media_audio.h"
+#include "media/clip/media_clip_check_streaming.h"
 #include "media/clip/media_clip_reader.h"
 #include "mtproto/facade.h"
 #include "lottie/lottie_animation.h"
@@ -32,6 +33,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image_prepare.h"
 #include "lang/lang_keys.h"
 #include "storage/file_download.h"
+#include "storage/storage_account.h"
 #include "storage/storage_media_prepare.h"
 #include "window/themes/window_theme_preview.h"
 #include "mainwidget.h"
@@ -48,6 +50,10 @@ constexpr auto kThumbnailSize = 320;
 constexpr auto kPhotoUploadPartSize = 32 * 1024;
 constexpr auto kRecompressAfterBpp = 4;
 
+// Remuxing writes a full copy before the upload starts,
+// so it is done only for videos that are copied quickly.
+constexpr auto kMakeStreamableMaxSize = 256 * 1024 * 1024;
+
 using Ui::ValidateThumbDimensions;
 
 base::options::toggle SendLargePhotos({
@@ -469,6 +475,12 @@ FileLoadResult::FileLoadResult(
 , spoiler(spoiler) {
 }
 
+FileLoadResult::~FileLoadResult() {
+	if (!uploadpath.isEmpty()) {
+		QFile::remove(uploadpath);
+	}
+}
+
 void FileLoadResult::setFileData(const QByteArray &filedata) {
 	if (filedata.isEmpty()) {
 		partssize = 0;
@@ -511,6 +523,7 @@ FileLoadTask::FileLoadTask(
 , _album(std::move(album))
 , _filepath(filepath)
 , _content(content)
+, _tempDirectory(session->local().tempDirectory())
 , _information(std::move(information))
 , _type(type)
 , _caption(caption)
@@ -862,6 +875,12 @@ void FileLoadTask::process(Args &&args) {
 			if (video->isGifv && !_album) {
 				attributes.push_back(MTP_documentAttributeAnimated());
 			}
+			if (!video->supportsStreaming
+				&& !video->isWebmSticker
+				&& filesize <= kMakeStreamableMaxSize
+				&& makeVideoStreamable(filename)) {
+				video->supportsStreaming = true;
+			}
 			auto flags = MTPDdocumentAttributeVideo::Flags(0);
 			if (video->supportsStreaming) {
 				flags |= MTPDdocumentAttributeVideo::Flag::f_supports_streaming;
@@ -1034,6 +1053,33 @@ void FileLoadTask::process(Args &&args) {
 	_result->photoThumbs = photoThumbs;
 }
 
+bool FileLoadTask::makeVideoStreamable(const QString &filename) {
+	if (!_content.isEmpty()) {
+		auto remuxed = Media::Clip::MakeStreamable(_content);
+		if (remuxed.isEmpty()) {
+			return false;
+		}
+		_content = std::move(remuxed);
+		return true;
+	} else if (_filepath.isEmpty() || _tempDirectory.isEmpty()) {
+		return false;
+	}
+	// The remuxed copy is only uploaded, the original file stays the
+	// local location of the sent document and the copy is removed
+	// together with the load result.
+	QDir().mkpath(_tempDirectory);
+	const auto path = _tempDirectory
+		+ QString::number(_id, 16)
+		+ '_'
+		+ filename;
+	if (!Media::Clip::MakeStreamable(_filepath, path)) {
+		QFile::remove(path);
+		return false;
+	}
+	_result->uploadpath = path;
+	return true;
+}
+
 void FileLoadTask::finish() {
 	const auto session = _session.get();
 	if (!session) {
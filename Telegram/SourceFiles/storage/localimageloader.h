@@ -190,6 +190,9 @@ struct FileLoadResult {
 		const TextWithTags &caption,
 		bool spoiler,
 		std::shared_ptr<SendingAlbum> album);
+	FileLoadResult(const FileLoadResult &other) = delete;
+	FileLoadResult &operator=(const FileLoadResult &other) = delete;
+	~FileLoadResult();
 
 	TaskId taskId;
 	uint64 id;
@@ -197,6 +200,7 @@ struct FileLoadResult {
 	std::shared_ptr<SendingAlbum> album;
 	SendMediaType type = SendMediaType::File;
 	QString filepath;
+	QString uploadpath; // Temporary remuxed copy of filepath, if any.
 	QByteArray content;
 
 	QString filename;
@@ -296,6 +300,7 @@ private:
 	static bool CheckMimeOrExtensions(const QString &filepath, const QString &filemime, Mimes &mimes, Extensions &extensions);
 
 	std::unique_ptr<Ui::PreparedFileInformation> readMediaInformation(const QString &filemime) const;
+	bool makeVideoStreamable(const QString &filename);
 	void removeFromAlbum();
 
 	uint64 _id = 0;
@@ -305,6 +310,7 @@ private:
 	const std::shared_ptr<SendingAlbum> _album;
 	QString _filepath;
 	QByteArray _content;
+	QString _tempDirectory;
 	std::unique_ptr<Ui::PreparedFileInformation> _information;
 	int32 _duration = 0;
 	VoiceWaveform _waveform;
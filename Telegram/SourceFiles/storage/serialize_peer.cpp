@@ -198,7 +198,8 @@ void writePeer(QDataStream &stream, not_null<PeerData*> peer) {
 PeerData *readPeer(
 		not_null<Main::Session*> session,
 		int streamAppVersion,
-		QDataStream &stream) {
+		QDataStream &stream,
+		bool markLoaded) {
 	quint64 peerIdSerialized = 0, versionTag = 0, photoId = 0;
 	qint32 version = 0, photoHasVideo = 0;
 	stream >> peerIdSerialized >> versionTag;
@@ -227,7 +228,7 @@ PeerData *readPeer(
 		: session->data().peerLoaded(peerId);
 	const auto apply = !loaded || !loaded->isLoaded();
 	const auto result = loaded ? loaded : session->data().peer(peerId).get();
-	if (apply) {
+	if (apply && markLoaded) {
 		result->setLoadedStatus(PeerData::LoadedStatus::Normal);
 	}
 	if (const auto user = result->asUser()) {
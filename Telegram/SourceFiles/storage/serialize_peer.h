@@ -38,7 +38,8 @@ void writePeer(QDataStream &stream, not_null<PeerData*> peer);
 PeerData *readPeer(
 	not_null<Main::Session*> session,
 	int streamAppVersion,
-	QDataStream &stream);
+	QDataStream &stream,
+	bool markLoaded = true);
 QString peekUserPhone(int streamAppVersion, QDataStream &stream);
 
 } // namespace Serialize
@@ -47,6 +47,9 @@ constexpr auto kStickersSerializeVersion = 3;
 constexpr auto kMaxSavedStickerSetsCount = 1000;
 constexpr auto kDefaultStickerInstallDate = TimeId(1);
 
+constexpr auto kPeersVersionTag = quint32(-1);
+constexpr auto kPeersSerializeVersion = 2;
+
 constexpr auto kSinglePeerTypeUserOld = qint32(1);
 constexpr auto kSinglePeerTypeChatOld = qint32(2);
 constexpr auto kSinglePeerTypeChannelOld = qint32(3);
@@ -85,6 +88,8 @@ enum { // Local Storage Keys
 	lskSelfSerialized = 0x15, // serialized self
 	lskMasksKeys = 0x16, // no data
 	lskCustomEmojiKeys = 0x17, // no data
+	lskDialogsSnapshot = 0x18, // no data
+	lskPeers = 0x19, // no data
 };
 
 auto EmptyMessageDraftSources()
@@ -207,6 +212,8 @@ base::flat_set<QString> Account::collectGoodNames() const {
 		_installedCustomEmojiKey,
 		_featuredCustomEmojiKey,
 		_archivedCustomEmojiKey,
+		_dialogsSnapshotKey,
+		_peersKey,
 	};
 	auto result = base::flat_set<QString>{
 		"map0",
@@ -289,6 +296,7 @@ Account::ReadMapResult Account::readMapWith(
 	quint64 installedStickersKey = 0, featuredStickersKey = 0, recentStickersKey = 0, favedStickersKey = 0, archivedStickersKey = 0;
 	quint64 installedMasksKey = 0, recentMasksKey = 0, archivedMasksKey = 0;
 	quint64 installedCustomEmojiKey = 0, featuredCustomEmojiKey = 0, archivedCustomEmojiKey = 0;
+	quint64 dialogsSnapshotKey = 0, peersKey = 0;
 	quint64 savedGifsKey = 0;
 	quint64 legacyBackgroundKeyDay = 0, legacyBackgroundKeyNight = 0;
 	quint64 userSettingsKey = 0, recentHashtagsAndBotsKey = 0, exportSettingsKey = 0;
@@ -397,6 +405,12 @@ Account::ReadMapResult Account::readMapWith(
 				>> featuredCustomEmojiKey
 				>> archivedCustomEmojiKey;
 		} break;
+		case lskDialogsSnapshot: {
+			map.stream >> dialogsSnapshotKey;
+		} break;
+		case lskPeers: {
+			map.stream >> peersKey;
+		} break;
 		default:
 			LOG(("App Error: unknown key type in encrypted map: %1").arg(keyType));
 			return ReadMapResult::Failed;
@@ -427,6 +441,8 @@ Account::ReadMapResult Account::readMapWith(
 	_installedCustomEmojiKey = installedCustomEmojiKey;
 	_featuredCustomEmojiKey = featuredCustomEmojiKey;
 	_archivedCustomEmojiKey = archivedCustomEmojiKey;
+	_dialogsSnapshotKey = dialogsSnapshotKey;
+	_peersKey = peersKey;
 	_legacyBackgroundKeyDay = legacyBackgroundKeyDay;
 	_legacyBackgroundKeyNight = legacyBackgroundKeyNight;
 	_settingsKey = userSettingsKey;
@@ -537,6 +553,8 @@ void Account::writeMap() {
 	if (_installedCustomEmojiKey || _featuredCustomEmojiKey || _archivedCustomEmojiKey) {
 		mapSize += sizeof(quint32) + 3 * sizeof(quint64);
 	}
+	if (_dialogsSnapshotKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_peersKey) mapSize += sizeof(quint32) + sizeof(quint64);
 
 	EncryptedDescriptor mapData(mapSize);
 	if (!self.isEmpty()) {
@@ -596,6 +614,12 @@ void Account::writeMap() {
 			<< quint64(_featuredCustomEmojiKey)
 			<< quint64(_archivedCustomEmojiKey);
 	}
+	if (_dialogsSnapshotKey) {
+		mapData.stream << quint32(lskDialogsSnapshot) << quint64(_dialogsSnapshotKey);
+	}
+	if (_peersKey) {
+		mapData.stream << quint32(lskPeers) << quint64(_peersKey);
+	}
 	map.writeEncrypted(mapData, _localKey);
 
 	_mapChanged = false;
@@ -620,6 +644,8 @@ void Account::reset() {
 	_installedCustomEmojiKey = 0;
 	_featuredCustomEmojiKey = 0;
 	_archivedCustomEmojiKey = 0;
+	_dialogsSnapshotKey = 0;
+	_peersKey = 0;
 	_legacyBackgroundKeyDay = _legacyBackgroundKeyNight = 0;
 	_settingsKey = _recentHashtagsAndBotsKey = _exportSettingsKey = 0;
 	_oldMapVersion = 0;
@@ -2751,6 +2777,120 @@ Export::Settings Account::readExportSettings() {
 		: Export::Settings();
 }
 
+void Account::writeDialogsSnapshot(const QByteArray &serialized) {
+	if (serialized.isEmpty()) {
+		if (_dialogsSnapshotKey) {
+			ClearKey(_dialogsSnapshotKey, _basePath);
+			_dialogsSnapshotKey = 0;
+			writeMapDelayed();
+		}
+		return;
+	}
+	if (!_dialogsSnapshotKey) {
+		_dialogsSnapshotKey = GenerateKey(_basePath);
+		writeMapQueued();
+	}
+	EncryptedDescriptor data(Serialize::bytearraySize(serialized));
+	data.stream << serialized;
+
+	FileWriteDescriptor file(_dialogsSnapshotKey, _basePath);
+	file.writeEncrypted(data, _localKey);
+}
+
+QByteArray Account::readDialogsSnapshot() {
+	if (!_dialogsSnapshotKey) {
+		return QByteArray();
+	}
+	FileReadDescriptor file;
+	if (!ReadEncryptedFile(file, _dialogsSnapshotKey, _basePath, _localKey)) {
+		ClearKey(_dialogsSnapshotKey, _basePath);
+		_dialogsSnapshotKey = 0;
+		writeMapDelayed();
+		return QByteArray();
+	}
+
+	// The snapshot holds raw API objects, they may not parse
+	// after the app was updated to a newer layer.
+	if (file.version != AppVersion) {
+		return QByteArray();
+	}
+	auto result = QByteArray();
+	file.stream >> result;
+	return CheckStreamStatus(file.stream) ? result : QByteArray();
+}
+
+void Account::writePeers(const std::vector<not_null<PeerData*>> &peers) {
+	if (peers.empty()) {
+		if (_peersKey) {
+			ClearKey(_peersKey, _basePath);
+			_peersKey = 0;
+			writeMapDelayed();
+		}
+		return;
+	}
+	if (!_peersKey) {
+		_peersKey = GenerateKey(_basePath);
+		writeMapQueued();
+	}
+
+	// All the peers are restored at once when the session is created.
+	auto size = sizeof(quint32) + sizeof(qint32) + sizeof(quint32);
+	for (const auto &peer : peers) {
+		size += Serialize::peerSize(peer);
+	}
+
+	EncryptedDescriptor data(size);
+	data.stream
+		<< quint32(kPeersVersionTag)
+		<< qint32(kPeersSerializeVersion)
+		<< quint32(peers.size());
+	for (const auto &peer : peers) {
+		Serialize::writePeer(data.stream, peer);
+	}
+
+	FileWriteDescriptor file(_peersKey, _basePath);
+	file.writeEncrypted(data, _localKey);
+}
+
+void Account::readPeers(not_null<Main::Session*> session) {
+	if (!_peersKey) {
+		return;
+	}
+
+	FileReadDescriptor file;
+	if (!ReadEncryptedFile(file, _peersKey, _basePath, _localKey)) {
+		ClearKey(_peersKey, _basePath);
+		_peersKey = 0;
+		writeMapDelayed();
+		return;
+	}
+	auto versionTag = quint32();
+	auto version = qint32();
+	auto count = quint32();
+	file.stream >> versionTag >> version >> count;
+	if (!CheckStreamStatus(file.stream)
+		|| versionTag != kPeersVersionTag
+		|| version != kPeersSerializeVersion) {
+		// Old data with each peer in a separate byte array.
+		ClearKey(_peersKey, _basePath);
+		_peersKey = 0;
+		writeMapDelayed();
+		return;
+	}
+	for (auto i = quint32(); i != count; ++i) {
+		// The peers stay not loaded, so any data from the server,
+		// even received a moment later, replaces the cached values.
+		const auto peer = Serialize::readPeer(
+			session,
+			file.version,
+			file.stream,
+			false);
+		if (!peer || !CheckStreamStatus(file.stream)) {
+			return;
+		}
+	}
+}
+
 void Account::writeSelf() {
 	writeMapDelayed();
 }
@@ -148,6 +148,12 @@ public:
 	void writeExportSettings(const Export::Settings &settings);
 	[[nodiscard]] Export::Settings readExportSettings();
 
+	void writeDialogsSnapshot(const QByteArray &serialized);
+	[[nodiscard]] QByteArray readDialogsSnapshot();
+
+	void writePeers(const std::vector<not_null<PeerData*>> &peers);
+	void readPeers(not_null<Main::Session*> session);
+
 	void writeSelf();
 
 	// Read self is special, it can't get session from account, because
@@ -291,6 +297,8 @@ private:
 	FileKey _installedCustomEmojiKey = 0;
 	FileKey _featuredCustomEmojiKey = 0;
 	FileKey _archivedCustomEmojiKey = 0;
+	FileKey _dialogsSnapshotKey = 0;
+	FileKey _peersKey = 0;
 
 	qint64 _cacheTotalSizeLimit = 0;
 	qint64 _cacheBigFileTotalSizeLimit = 0;
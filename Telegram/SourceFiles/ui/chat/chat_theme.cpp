@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/style/style_palette_colorizer.h"
 
 #include <crl/crl_async.h>
+#include <QtCore/QMutex>
 #include <QtGui/QGuiApplication>
 
 namespace Ui {
@@ -30,6 +31,10 @@ constexpr auto kMaxSize = 2960;
 constexpr auto kMaxContrastValue = 21.;
 constexpr auto kMinAcceptableContrast = 1.14;// 4.5;
 
+// Complex gradient rotation goes through 16 states, keep the whole cycle.
+constexpr auto kGradientKeyframesLimit = size_t(16);
+constexpr auto kPatternTilesLimit = size_t(2);
+
 [[nodiscard]] QColor DefaultBackgroundColor() {
 	return QColor(213, 223, 233);
 }
@@ -53,19 +58,113 @@ constexpr auto kMinAcceptableContrast = 1.14;// 4.5;
 	return (doubled % 2) ? 0.5 : 1.;
 }
 
+} // namespace
+
+// Owned by a chat theme and dropped with its background,
+// CacheBackground() runs on any thread.
+class BackgroundKeyframes final {
+public:
+	[[nodiscard]] QImage gradient(const CacheBackgroundRequest &request);
+	[[nodiscard]] QImage patternTile(const QImage &prepared, int size);
+
+private:
+	struct Gradient {
+		std::vector<QColor> colors;
+		QSize size;
+		int rotation = 0;
+		float64 progress = 0.;
+		QImage image;
+	};
+	struct Tile {
+		qint64 key = 0;
+		int size = 0;
+		QImage image;
+	};
+
+	QMutex _mutex;
+	std::vector<Gradient> _gradients;
+	std::vector<Tile> _tiles;
+
+};
+
+QImage BackgroundKeyframes::gradient(const CacheBackgroundRequest &request) {
+	const auto &colors = request.background.colors;
+	const auto size = request.background.gradientForFill.size();
+	const auto rotation = ComputeRealRotation(request);
+	const auto progress = ComputeRealProgress(request);
+	const auto same = [&](const Gradient &gradient) {
+		return (gradient.size == size)
+			&& (gradient.rotation == rotation)
+			&& (gradient.progress == progress)
+			&& (gradient.colors == colors);
+	};
+	{
+		QMutexLocker lock(&_mutex);
+		const auto i = ranges::find_if(_gradients, same);
+		if (i != end(_gradients)) {
+			return i->image;
+		}
+	}
+	auto image = Images::GenerateGradient(size, colors, rotation, progress);
+
+	QMutexLocker lock(&_mutex);
+	if (ranges::none_of(_gradients, same)) {
+		if (_gradients.size() >= kGradientKeyframesLimit) {
+			_gradients.erase(begin(_gradients));
+		}
+		_gradients.push_back({
+			.colors = colors,
+			.size = size,
+			.rotation = rotation,
+			.progress = progress,
+			.image = image,
+		});
+	}
+	return image;
+}
+
+QImage BackgroundKeyframes::patternTile(const QImage &prepared, int size) {
+	const auto key = prepared.cacheKey();
+	const auto same = [&](const Tile &tile) {
+		return (tile.key == key) && (tile.size == size);
+	};
+	{
+		QMutexLocker lock(&_mutex);
+		const auto i = ranges::find_if(_tiles, same);
+		if (i != end(_tiles)) {
+			return i->image;
+		}
+	}
+	auto image = prepared.scaled(
+		size,
+		size,
+		Qt::KeepAspectRatio,
+		Qt::SmoothTransformation);
+
+	QMutexLocker lock(&_mutex);
+	if (ranges::none_of(_tiles, same)) {
+		if (_tiles.size() >= kPatternTilesLimit) {
+			_tiles.erase(begin(_tiles));
+		}
+		_tiles.push_back({ .key = key, .size = size, .image = image });
+	}
+	return image;
+}
+
+namespace {
+
 [[nodiscard]] CacheBackgroundResult CacheBackgroundByRequest(
 		const CacheBackgroundRequest &request) {
 	Expects(!request.area.isEmpty());
 
+	const auto keyframes = request.keyframes
+		? request.keyframes
+		: std::make_shared<BackgroundKeyframes>();
 	const auto ratio = style::DevicePixelRatio();
 	const auto gradient = request.background.gradientForFill.isNull()
 		? QImage()
 		: (request.gradientRotationAdd != 0)
-		? Images::GenerateGradient(
-			request.background.gradientForFill.size(),
-			request.background.colors,
-			ComputeRealRotation(request),
-			ComputeRealProgress(request))
+		? keyframes->gradient(request)
 		: request.background.gradientForFill;
 	if (request.background.isPattern
 		|| request.background.tile
@@ -91,11 +190,9 @@ constexpr auto kMinAcceptableContrast = 1.14;// 4.5;
 				}
 			}
 			const auto tiled = request.background.isPattern
-				? request.background.prepared.scaled(
-					request.area.height() * ratio,
-					request.area.height() * ratio,
-					Qt::KeepAspectRatio,
-					Qt::SmoothTransformation)
+				? keyframes->patternTile(
+					request.background.prepared,
+					request.area.height() * ratio)
 				: request.background.preparedForTiled;
 			const auto w = tiled.width() / float(ratio);
 			const auto h = tiled.height() / float(ratio);
@@ -403,6 +500,7 @@ void ChatTheme::adjust(const style::color &my, const style::colorizer &by) {
 
 void ChatTheme::setBackground(ChatThemeBackground &&background) {
 	_mutableBackground = std::move(background);
+	_backgroundKeyframes = std::make_shared<BackgroundKeyframes>();
 	_backgroundState = {};
 	_backgroundNext = {};
 	_backgroundFade.stop();
@@ -417,6 +515,7 @@ void ChatTheme::updateBackgroundImageFrom(ChatThemeBackground &&background) {
 	_mutableBackground.prepared = std::move(background.prepared);
 	_mutableBackground.preparedForTiled = std::move(
 		background.preparedForTiled);
+	_backgroundKeyframes = std::make_shared<BackgroundKeyframes>();
 	if (!_backgroundState.now.pixmap.isNull()) {
 		if (_cacheBackgroundTimer) {
 			_cacheBackgroundTimer->cancel();
@@ -442,13 +541,12 @@ void ChatTheme::setBubblesBackground(QImage image) {
 		//_repaintBackgroundRequests.fire({});
 		return;
 	}
+	// Scaled to the viewport by tiles when painting the bubbles.
 	_bubblesBackground = CacheBackground({
 		.background = {
 			.prepared = _bubblesBackgroundPrepared,
 		},
-		.area = (_bubblesBackground.area.isEmpty()
-			? _bubblesBackgroundPrepared.size()
-			: _bubblesBackground.area),
+		.area = _bubblesBackgroundPrepared.size(),
 	});
 	if (!_bubblesBackgroundPattern) {
 		_bubblesBackgroundPattern = PrepareBubblePattern(palette());
@@ -469,21 +567,7 @@ ChatPaintContext ChatTheme::preparePaintContext(
 		QRect viewport,
 		QRect clip,
 		bool paused) {
-	const auto area = viewport.size();
 	const auto now = crl::now();
-	if (!_bubblesBackgroundPrepared.isNull()
-		&& _bubblesBackground.area != area) {
-		if (!_cacheBubblesTimer) {
-			_cacheBubblesTimer.emplace([=] { cacheBubbles(); });
-		}
-		if (_cacheBubblesArea != area
-			|| (!_cacheBubblesTimer->isActive()
-				&& !_bubblesCachingRequest)) {
-			_cacheBubblesArea = area;
-			_lastBubblesAreaChangeTime = now;
-			_cacheBubblesTimer->callOnce(kCacheBackgroundFastTimeout);
-		}
-	}
 	return {
 		.st = st,
 		.bubblesPattern = _bubblesBackgroundPattern.get(),
@@ -573,6 +657,7 @@ auto ChatTheme::cacheBackgroundRequest(QSize area, int addRotation) const
 		.background = background(),
 		.area = area,
 		.gradientRotationAdd = addRotation,
+		.keyframes = _backgroundKeyframes,
 	};
 }
 
@@ -651,64 +736,6 @@ void ChatTheme::setCachedBackground(CacheBackgroundResult &&cached) {
 		kBackgroundFadeDuration);
 }
 
-auto ChatTheme::cacheBubblesRequest(QSize area) const
--> CacheBackgroundRequest {
-	if (_bubblesBackgroundPrepared.isNull()) {
-		return {};
-	}
-	return {
-		.background = {
-			.gradientForFill = _bubblesBackgroundPrepared,
-		},
-		.area = area,
-	};
-}
-
-void ChatTheme::cacheBubbles() {
-	Expects(_cacheBubblesTimer.has_value());
-
-	const auto now = crl::now();
-	if (now - _lastBubblesAreaChangeTime < kCacheBackgroundTimeout
-		&& QGuiApplication::mouseButtons() != 0) {
-		_cacheBubblesTimer->callOnce(kCacheBackgroundFastTimeout);
-		return;
-	}
-	cacheBubblesNow();
-}
-
-void ChatTheme::cacheBubblesNow() {
-	if (!_bubblesCachingRequest) {
-		if (const auto request = cacheBackgroundRequest(
-				_cacheBubblesArea)) {
-			cacheBubblesAsync(request);
-		}
-	}
-}
-
-void ChatTheme::cacheBubblesAsync(
-		const CacheBackgroundRequest &request) {
-	_bubblesCachingRequest = request;
-	const auto weak = base::make_weak(this);
-	crl::async([=] {
-		if (!weak) {
-			return;
-		}
-		crl::on_main(weak, [=, result = CacheBackground(request)]() mutable {
-			if (const auto request = cacheBubblesRequest(
-					_cacheBubblesArea)) {
-				if (_bubblesCachingRequest != request) {
-					cacheBubblesAsync(request);
-				} else {
-					_bubblesCachingRequest = {};
-					_bubblesBackground = std::move(result);
-					_bubblesBackgroundPattern->pixmap
-						= _bubblesBackground.pixmap;
-				}
-			}
-		});
-	});
-}
-
 rpl::producer<> ChatTheme::repaintBackgroundRequests() const {
 	return _repaintBackgroundRequests.events();
 }
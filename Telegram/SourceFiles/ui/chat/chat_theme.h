@@ -21,6 +21,7 @@ namespace Ui {
 class ChatStyle;
 struct ChatPaintContext;
 struct BubblePattern;
+class BackgroundKeyframes;
 
 struct ChatThemeBackground {
 	QString key;
@@ -67,6 +68,7 @@ struct CacheBackgroundRequest {
 	QSize area;
 	int gradientRotationAdd = 0;
 	float64 gradientProgress = 1.;
+	std::shared_ptr<BackgroundKeyframes> keyframes;
 
 	explicit operator bool() const {
 		return !background.prepared.isNull()
@@ -180,13 +182,6 @@ private:
 	[[nodiscard]] bool readyForBackgroundRotation() const;
 	void generateNextBackgroundRotation();
 
-	void cacheBubbles();
-	void cacheBubblesNow();
-	void cacheBubblesAsync(
-		const CacheBackgroundRequest &request);
-	[[nodiscard]] CacheBackgroundRequest cacheBubblesRequest(
-		QSize area) const;
-
 	[[nodiscard]] style::colorizer bubblesAccentColorizer(
 		const QColor &accent) const;
 	void adjustPalette(const ChatThemeDescriptor &descriptor);
@@ -197,6 +192,7 @@ private:
 	ChatThemeKey _key;
 	std::unique_ptr<style::palette> _palette;
 	ChatThemeBackground _mutableBackground;
+	std::shared_ptr<BackgroundKeyframes> _backgroundKeyframes;
 	BackgroundState _backgroundState;
 	Animations::Simple _backgroundFade;
 	CacheBackgroundRequest _backgroundCachingRequest;
@@ -207,10 +203,6 @@ private:
 
 	CachedBackground _bubblesBackground;
 	QImage _bubblesBackgroundPrepared;
-	CacheBackgroundRequest _bubblesCachingRequest;
-	QSize _cacheBubblesArea;
-	crl::time _lastBubblesAreaChangeTime = 0;
-	std::optional<base::Timer> _cacheBubblesTimer;
 	std::unique_ptr<BubblePattern> _bubblesBackgroundPattern;
 
 	rpl::event_stream<> _repaintBackgroundRequests;
@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/cached_round_corners.h"
 #include "ui/image/image_prepare.h"
 #include "ui/chat/chat_style.h"
+#include "ui/ui_utility.h"
 #include "styles/style_chat.h"
 
 namespace Ui {
@@ -17,6 +18,57 @@ namespace {
 
 using Corner = BubbleCornerRounding;
 
+constexpr auto kPatternTileSize = 256;
+constexpr auto kPatternTilesViewports = size_t(2);
+
+[[nodiscard]] QPixmap RenderPatternTile(
+		const QPixmap &source,
+		QSize viewport,
+		QRect tile) {
+	const auto ratio = style::DevicePixelRatio();
+	auto image = QImage(
+		tile.size() * ratio,
+		QImage::Format_ARGB32_Premultiplied);
+	image.setDevicePixelRatio(ratio);
+	image.fill(Qt::transparent);
+
+	const auto sx = source.width() / float64(viewport.width());
+	const auto sy = source.height() / float64(viewport.height());
+	auto p = QPainter(&image);
+	p.setRenderHint(QPainter::SmoothPixmapTransform);
+	p.drawPixmap(
+		QRectF(QPointF(), QSizeF(tile.size())),
+		source,
+		QRectF(
+			tile.x() * sx,
+			tile.y() * sy,
+			tile.width() * sx,
+			tile.height() * sy));
+	p.end();
+
+	return PixmapFromImage(std::move(image));
+}
+
+[[nodiscard]] BubblePatternTiles &PatternTiles(
+		const BubblePattern &pattern,
+		QSize viewport) {
+	const auto sourceKey = pattern.pixmap.cacheKey();
+	auto &list = pattern.tiles;
+	const auto i = ranges::find_if(list, [&](const BubblePatternTiles &t) {
+		return (t.sourceKey == sourceKey) && (t.viewport == viewport);
+	});
+	if (i != end(list)) {
+		// Keep the most recently used viewport last.
+		std::rotate(i, i + 1, end(list));
+		return list.back();
+	}
+	if (list.size() >= kPatternTilesViewports) {
+		list.erase(begin(list));
+	}
+	list.push_back({ .sourceKey = sourceKey, .viewport = viewport });
+	return list.back();
+}
+
 template <
 	typename FillBg, // fillBg(QRect rect)
 	typename FillSh, // fillSh(QRect rect)
@@ -171,7 +223,7 @@ void PaintPatternBubble(QPainter &p, const SimpleBubble &args) {
 			PaintPatternBubblePart(
 				p,
 				args.patternViewport,
-				pattern->pixmap,
+				*pattern,
 				fill);
 		}
 	};
@@ -188,7 +240,7 @@ void PaintPatternBubble(QPainter &p, const SimpleBubble &args) {
 		PaintPatternBubblePart(
 			p,
 			args.patternViewport,
-			pattern->pixmap,
+			*pattern,
 			QRect(QPoint(x, y), mask.size() / int(mask.devicePixelRatio())),
 			mask,
 			cache);
@@ -365,30 +417,39 @@ void PaintBubble(QPainter &p, const ComplexBubble &args) {
 void PaintPatternBubblePart(
 		QPainter &p,
 		const QRect &viewport,
-		const QPixmap &pixmap,
+		const BubblePattern &pattern,
 		const QRect &target) {
-	const auto factor = pixmap.devicePixelRatio();
-	if (viewport.size() * factor == pixmap.size()) {
-		const auto fill = target.intersected(viewport);
-		if (fill.isEmpty()) {
-			return;
-		}
-		p.drawPixmap(fill, pixmap, QRect(
-			(fill.topLeft() - viewport.topLeft()) * factor,
-			fill.size() * factor));
-	} else {
-		const auto to = viewport;
-		const auto from = QRect(QPoint(), pixmap.size());
-		const auto deviceRect = QRect(
-			QPoint(),
-			QSize(p.device()->width(), p.device()->height()));
-		const auto clip = (target != deviceRect);
-		if (clip) {
-			p.setClipRect(target);
-		}
-		p.drawPixmap(to, pixmap, from);
-		if (clip) {
-			p.setClipping(false);
+	const auto fill = target.intersected(viewport);
+	if (fill.isEmpty()) {
+		return;
+	}
+	const auto ratio = style::DevicePixelRatio();
+	const auto size = viewport.size();
+	const auto local = fill.translated(-viewport.topLeft());
+	const auto fromColumn = local.x() / kPatternTileSize;
+	const auto tillColumn = (local.x() + local.width() - 1)
+		/ kPatternTileSize;
+	const auto fromRow = local.y() / kPatternTileSize;
+	const auto tillRow = (local.y() + local.height() - 1) / kPatternTileSize;
+	auto &tiles = PatternTiles(pattern, size).list;
+	for (auto row = fromRow; row <= tillRow; ++row) {
+		for (auto column = fromColumn; column <= tillColumn; ++column) {
+			const auto tile = QRect(
+				column * kPatternTileSize,
+				row * kPatternTileSize,
+				kPatternTileSize,
+				kPatternTileSize).intersected(QRect(QPoint(), size));
+			auto &pixmap = tiles[(row << 16) | column];
+			if (pixmap.isNull()) {
+				pixmap = RenderPatternTile(pattern.pixmap, size, tile);
+			}
+			const auto part = tile.intersected(local);
+			p.drawPixmap(
+				part.translated(viewport.topLeft()),
+				pixmap,
+				QRect(
+					(part.topLeft() - tile.topLeft()) * ratio,
+					part.size() * ratio));
 		}
 	}
 }
@@ -396,7 +457,7 @@ void PaintPatternBubblePart(
 void PaintPatternBubblePart(
 		QPainter &p,
 		const QRect &viewport,
-		const QPixmap &pixmap,
+		const BubblePattern &pattern,
 		const QRect &target,
 		const QImage &mask,
 		QImage &cache) {
@@ -417,7 +478,7 @@ void PaintPatternBubblePart(
 	PaintPatternBubblePart(
 		q,
 		viewport.translated(-target.topLeft()),
-		pixmap,
+		pattern,
 		QRect(QPoint(), cache.size() / int(cache.devicePixelRatio())));
 	q.end();
 
@@ -427,7 +488,7 @@ void PaintPatternBubblePart(
 void PaintPatternBubblePart(
 		QPainter &p,
 		const QRect &viewport,
-		const QPixmap &pixmap,
+		const BubblePattern &pattern,
 		const QRect &target,
 		Fn<void(QPainter&)> paintContent,
 		QImage &cache) {
@@ -450,7 +511,7 @@ void PaintPatternBubblePart(
 	PaintPatternBubblePart(
 		q,
 		viewport.translated(-targetOrigin),
-		pixmap,
+		pattern,
 		QRect(QPoint(), targetSize));
 	q.end();
 
@@ -87,6 +87,13 @@ struct BubbleSelectionInterval {
 	int height = 0;
 };
 
+// Parts of the pattern scaled to the viewport, rendered on demand.
+struct BubblePatternTiles {
+	qint64 sourceKey = 0;
+	QSize viewport;
+	base::flat_map<int, QPixmap> list;
+};
+
 struct BubblePattern {
 	QPixmap pixmap;
 	std::array<QImage, 4> cornersSmall;
@@ -98,6 +105,7 @@ struct BubblePattern {
 	mutable QImage cornerBottomSmallCache;
 	mutable QImage cornerBottomLargeCache;
 	mutable QImage tailCache;
+	mutable std::vector<BubblePatternTiles> tiles;
 };
 
 [[nodiscard]] std::unique_ptr<BubblePattern> PrepareBubblePattern(
@@ -127,13 +135,13 @@ void PaintBubble(QPainter &p, const ComplexBubble &args);
 void PaintPatternBubblePart(
 	QPainter &p,
 	const QRect &viewport,
-	const QPixmap &pixmap,
+	const BubblePattern &pattern,
 	const QRect &target);
 
 void PaintPatternBubblePart(
 	QPainter &p,
 	const QRect &viewport,
-	const QPixmap &pixmap,
+	const BubblePattern &pattern,
 	const QRect &target,
 	const QImage &mask,
 	QImage &cache);
@@ -141,7 +149,7 @@ void PaintPatternBubblePart(
 void PaintPatternBubblePart(
 	QPainter &p,
 	const QRect &viewport,
-	const QPixmap &pixmap,
+	const BubblePattern &pattern,
 	const QRect &target,
 	Fn<void(QPainter&)> paintContent,
 	QImage &cache);
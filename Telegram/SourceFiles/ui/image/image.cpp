@@ -13,8 +13,47 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/ui_utility.h"
 #include "core/application.h"
 
+#include <QtCore/QCoreApplication>
+#include <QtCore/QThread>
+
+#include <unordered_set>
+
 using namespace Images;
 
+namespace {
+
+// Scaled variants of all images share one budget, the least recently
+// used ones are dropped from the main loop when it is exceeded.
+constexpr auto kPixCacheLimit = int64(192 * 1024 * 1024);
+constexpr auto kPixCacheEvictTill = kPixCacheLimit * 3 / 4;
+
+struct PixCacheState {
+	std::unordered_set<const Image*> images;
+	int64 bytes = 0;
+	uint64 clock = 0;
+	uint64 hits = 0;
+	uint64 misses = 0;
+	bool evictionScheduled = false;
+};
+
+[[nodiscard]] PixCacheState &PixCache() {
+	// Never destroyed, static images may outlive it otherwise.
+	static const auto result = new PixCacheState();
+	return *result;
+}
+
+// The cache state is shared by all images without a lock,
+// pixmaps are used only on the main thread anyway.
+[[nodiscard]] bool InMainThread() {
+	return (QThread::currentThread() == QCoreApplication::instance()->thread());
+}
+
+[[nodiscard]] int64 PixBytes(const QPixmap &pixmap) {
+	return int64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+} // namespace
+
 namespace Images {
 namespace {
 
@@ -311,6 +350,19 @@ Image::Image(QImage &&data)
 	Expects(!_data.isNull());
 }
 
+Image::~Image() {
+	if (_cache.empty()) {
+		return;
+	}
+	Expects(InMainThread());
+
+	auto &cache = PixCache();
+	for (const auto &[key, entry] : _cache) {
+		cache.bytes -= PixBytes(entry.pixmap);
+	}
+	cache.images.erase(this);
+}
+
 not_null<Image*> Image::Empty() {
 	static auto result = Image([] {
 		const auto factor = cIntRetinaFactor();
@@ -348,6 +400,8 @@ const QPixmap &Image::cached(
 		int h,
 		const Images::PrepareArgs &args,
 		bool single) const {
+	Expects(InMainThread());
+
 	const auto ratio = style::DevicePixelRatio();
 	if (w <= 0 || !width() || !height()) {
 		w = width();
@@ -361,10 +415,75 @@ const QPixmap &Image::cached(
 	const auto outer = args.outer;
 	const auto size = outer.isEmpty() ? QSize(w, h) : outer * ratio;
 	const auto k = single ? SinglePixKey(args) : PixKey(w, h, args);
-	const auto i = _cache.find(k);
-	return (i != _cache.cend() && i->second.size() == size)
-		? i->second
-		: _cache.emplace_or_assign(k, prepare(w, h, args)).first->second;
+	auto &cache = PixCache();
+	auto i = _cache.find(k);
+	if (i != _cache.end() && i->second.pixmap.size() == size) {
+		++cache.hits;
+		i->second.lastUsed = ++cache.clock;
+		return i->second.pixmap;
+	}
+	++cache.misses;
+	if (i != _cache.end()) {
+		cache.bytes -= PixBytes(i->second.pixmap);
+		i->second = CachedPix{ prepare(w, h, args), ++cache.clock };
+	} else {
+		i = _cache.emplace(
+			k,
+			CachedPix{ prepare(w, h, args), ++cache.clock }).first;
+		if (_cache.size() == 1) {
+			cache.images.emplace(this);
+		}
+	}
+	cache.bytes += PixBytes(i->second.pixmap);
+	if (cache.bytes > kPixCacheLimit && !cache.evictionScheduled) {
+		cache.evictionScheduled = true;
+		crl::on_main(EvictCached);
+	}
+	return i->second.pixmap;
+}
+
+void Image::EvictCached() {
+	Expects(InMainThread());
+
+	auto &cache = PixCache();
+	cache.evictionScheduled = false;
+	if (cache.bytes <= kPixCacheLimit) {
+		return;
+	}
+	struct Candidate {
+		const Image *image = nullptr;
+		uint64 key = 0;
+		uint64 lastUsed = 0;
+	};
+	auto candidates = std::vector<Candidate>();
+	for (const auto image : cache.images) {
+		for (const auto &[key, entry] : image->_cache) {
+			candidates.push_back({ image, key, entry.lastUsed });
+		}
+	}
+	ranges::sort(candidates, ranges::less(), &Candidate::lastUsed);
+
+	auto evicted = 0;
+	for (const auto &candidate : candidates) {
+		if (cache.bytes <= kPixCacheEvictTill) {
+			break;
+		}
+		auto &entries = candidate.image->_cache;
+		const auto i = entries.find(candidate.key);
+		cache.bytes -= PixBytes(i->second.pixmap);
+		entries.erase(i);
+		if (entries.empty()) {
+			cache.images.erase(candidate.image);
+		}
+		++evicted;
+	}
+	const auto requests = std::max(cache.hits + cache.misses, uint64(1));
+	DEBUG_LOG(("Image Info: Evicted %1 cached pixmaps, %2 KB left, "
+		"hit rate %3%."
+		).arg(evicted
+		).arg(cache.bytes / 1024
+		).arg(cache.hits * 100 / requests));
+	cache.hits = cache.misses = 0;
 }
 
 QPixmap Image::prepare(int w, int h, const Images::PrepareArgs &args) const {
@@ -24,6 +24,9 @@ public:
 	explicit Image(const QString &path);
 	explicit Image(const QByteArray &content);
 	explicit Image(QImage &&data);
+	Image(const Image &other) = delete;
+	Image &operator=(const Image &other) = delete;
+	~Image();
 
 	[[nodiscard]] static not_null<Image*> Empty(); // 1x1 transparent
 	[[nodiscard]] static not_null<Image*> BlankMedia(); // 1x1 black
@@ -96,6 +99,13 @@ public:
 	}
 
 private:
+	struct CachedPix {
+		QPixmap pixmap;
+		uint64 lastUsed = 0;
+	};
+
+	static void EvictCached();
+
 	[[nodiscard]] QPixmap prepare(
 		int w,
 		int h,
@@ -107,6 +117,6 @@ private:
 		bool single) const;
 
 	const QImage _data;
-	mutable base::flat_map<uint64, QPixmap> _cache;
+	mutable base::flat_map<uint64, CachedPix> _cache;
 
 };